@@ -0,0 +1,55 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by CMake Version 3.25
+cmake_policy(SET CMP0009 NEW)
+
+# BENCH_FILES at CMakeLists.txt:195 (file)
+file(GLOB NEW_GLOB LIST_DIRECTORIES true "/root/repo/bench/*_bench.cpp")
+set(OLD_GLOB
+  "/root/repo/bench/nv_detector_bench.cpp"
+  "/root/repo/bench/nv_detector_lock_bench.cpp"
+  "/root/repo/bench/nv_detector_scaling_bench.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_rel_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# EXAMPLE_FILES at CMakeLists.txt:110 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/examples/*_test.cpp")
+set(OLD_GLOB
+  "/root/repo/examples/deadlock_test.cpp"
+  "/root/repo/examples/memory_leak_test.cpp"
+  "/root/repo/examples/plthook_test.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_rel_build/CMakeFiles/cmake.verify_globs")
+endif()
+
+# SRC_FILES at CMakeLists.txt:62 (file)
+file(GLOB_RECURSE NEW_GLOB LIST_DIRECTORIES false "/root/repo/src/*.cpp")
+set(OLD_GLOB
+  "/root/repo/src/autostart.cpp"
+  "/root/repo/src/blocking_detect.cpp"
+  "/root/repo/src/control_socket.cpp"
+  "/root/repo/src/copy_detect.cpp"
+  "/root/repo/src/detector.cpp"
+  "/root/repo/src/detector_service.cpp"
+  "/root/repo/src/exception_detect.cpp"
+  "/root/repo/src/fd_detect.cpp"
+  "/root/repo/src/function_trace.cpp"
+  "/root/repo/src/io_detect.cpp"
+  "/root/repo/src/latency_histogram.cpp"
+  "/root/repo/src/lock_detect.cpp"
+  "/root/repo/src/memory_detect.cpp"
+  "/root/repo/src/output_control.cpp"
+  "/root/repo/src/overhead.cpp"
+  "/root/repo/src/plthook_elf64.cpp"
+  "/root/repo/src/prometheus_export.cpp"
+  "/root/repo/src/stats_segment.cpp"
+  "/root/repo/src/thread_detect.cpp"
+  )
+if(NOT "${NEW_GLOB}" STREQUAL "${OLD_GLOB}")
+  message("-- GLOB mismatch!")
+  file(TOUCH_NOCREATE "/root/repo/_rel_build/CMakeFiles/cmake.verify_globs")
+endif()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/deadlock_test.dir/examples/deadlock_test.cpp.o"
+  "CMakeFiles/deadlock_test.dir/examples/deadlock_test.cpp.o.d"
+  "examples/deadlock_test"
+  "examples/deadlock_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/deadlock_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
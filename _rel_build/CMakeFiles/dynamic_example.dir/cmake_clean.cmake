@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/dynamic_example.dir/examples/dynamic_example.cpp.o"
+  "CMakeFiles/dynamic_example.dir/examples/dynamic_example.cpp.o.d"
+  "examples/libdynamic_example.pdb"
+  "examples/libdynamic_example.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/dynamic_example.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
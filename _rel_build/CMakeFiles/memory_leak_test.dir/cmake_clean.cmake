@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/memory_leak_test.dir/examples/memory_leak_test.cpp.o"
+  "CMakeFiles/memory_leak_test.dir/examples/memory_leak_test.cpp.o.d"
+  "examples/memory_leak_test"
+  "examples/memory_leak_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/memory_leak_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,37 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/autostart.cpp" "CMakeFiles/nv_detector.dir/src/autostart.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/autostart.cpp.o.d"
+  "/root/repo/src/blocking_detect.cpp" "CMakeFiles/nv_detector.dir/src/blocking_detect.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/blocking_detect.cpp.o.d"
+  "/root/repo/src/control_socket.cpp" "CMakeFiles/nv_detector.dir/src/control_socket.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/control_socket.cpp.o.d"
+  "/root/repo/src/copy_detect.cpp" "CMakeFiles/nv_detector.dir/src/copy_detect.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/copy_detect.cpp.o.d"
+  "/root/repo/src/detector.cpp" "CMakeFiles/nv_detector.dir/src/detector.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/detector.cpp.o.d"
+  "/root/repo/src/detector_service.cpp" "CMakeFiles/nv_detector.dir/src/detector_service.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/detector_service.cpp.o.d"
+  "/root/repo/src/exception_detect.cpp" "CMakeFiles/nv_detector.dir/src/exception_detect.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/exception_detect.cpp.o.d"
+  "/root/repo/src/fd_detect.cpp" "CMakeFiles/nv_detector.dir/src/fd_detect.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/fd_detect.cpp.o.d"
+  "/root/repo/src/function_trace.cpp" "CMakeFiles/nv_detector.dir/src/function_trace.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/function_trace.cpp.o.d"
+  "/root/repo/src/io_detect.cpp" "CMakeFiles/nv_detector.dir/src/io_detect.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/io_detect.cpp.o.d"
+  "/root/repo/src/latency_histogram.cpp" "CMakeFiles/nv_detector.dir/src/latency_histogram.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/latency_histogram.cpp.o.d"
+  "/root/repo/src/lock_detect.cpp" "CMakeFiles/nv_detector.dir/src/lock_detect.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/lock_detect.cpp.o.d"
+  "/root/repo/src/memory_detect.cpp" "CMakeFiles/nv_detector.dir/src/memory_detect.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/memory_detect.cpp.o.d"
+  "/root/repo/src/output_control.cpp" "CMakeFiles/nv_detector.dir/src/output_control.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/output_control.cpp.o.d"
+  "/root/repo/src/overhead.cpp" "CMakeFiles/nv_detector.dir/src/overhead.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/overhead.cpp.o.d"
+  "/root/repo/src/plthook_elf64.cpp" "CMakeFiles/nv_detector.dir/src/plthook_elf64.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/plthook_elf64.cpp.o.d"
+  "/root/repo/src/prometheus_export.cpp" "CMakeFiles/nv_detector.dir/src/prometheus_export.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/prometheus_export.cpp.o.d"
+  "/root/repo/src/stats_segment.cpp" "CMakeFiles/nv_detector.dir/src/stats_segment.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/stats_segment.cpp.o.d"
+  "/root/repo/src/thread_detect.cpp" "CMakeFiles/nv_detector.dir/src/thread_detect.cpp.o" "gcc" "CMakeFiles/nv_detector.dir/src/thread_detect.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,47 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nv_detector.dir/src/autostart.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/autostart.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/blocking_detect.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/blocking_detect.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/control_socket.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/control_socket.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/copy_detect.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/copy_detect.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/detector.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/detector.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/detector_service.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/detector_service.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/exception_detect.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/exception_detect.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/fd_detect.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/fd_detect.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/function_trace.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/function_trace.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/io_detect.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/io_detect.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/latency_histogram.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/latency_histogram.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/lock_detect.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/lock_detect.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/memory_detect.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/memory_detect.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/output_control.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/output_control.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/overhead.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/overhead.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/plthook_elf64.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/plthook_elf64.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/prometheus_export.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/prometheus_export.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/stats_segment.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/stats_segment.cpp.o.d"
+  "CMakeFiles/nv_detector.dir/src/thread_detect.cpp.o"
+  "CMakeFiles/nv_detector.dir/src/thread_detect.cpp.o.d"
+  "bin/libnv_detector.pdb"
+  "bin/libnv_detector.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nv_detector.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nv_detector_lock_bench.dir/bench/nv_detector_lock_bench.cpp.o"
+  "CMakeFiles/nv_detector_lock_bench.dir/bench/nv_detector_lock_bench.cpp.o.d"
+  "bin/nv_detector_lock_bench"
+  "bin/nv_detector_lock_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nv_detector_lock_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nv_detector_top.dir/tools/nv_detector_top.cpp.o"
+  "CMakeFiles/nv_detector_top.dir/tools/nv_detector_top.cpp.o.d"
+  "bin/nv_detector_top"
+  "bin/nv_detector_top.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nv_detector_top.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/plthook_test.dir/examples/plthook_test.cpp.o"
+  "CMakeFiles/plthook_test.dir/examples/plthook_test.cpp.o.d"
+  "examples/plthook_test"
+  "examples/plthook_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/plthook_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/run_plthook_test"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/run_plthook_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
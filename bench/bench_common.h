@@ -0,0 +1,68 @@
+#pragma once
+// Helpers shared by the benchmarks under bench/.
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+namespace bench {
+// Keeps the compiler from eliding an allocation or the work on it.
+template <typename T>
+inline auto DoNotOptimize(const T& value) -> void {
+  __asm__ volatile("" : : "r,m"(value) : "memory");
+}
+inline auto NowNs() -> uint64_t {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+// Hooks cannot be removed once installed, so every detector configuration
+// runs in its own forked child. The child's stdout (where the detector
+// prints) goes to /dev/null; whatever `body` writes to the given descriptor
+// is returned. Empty if the child failed.
+inline auto RunInChild(const std::function<void(int)>& body) -> std::string {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return {};
+  }
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return {};
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) {
+      dup2(null_fd, STDOUT_FILENO);
+      close(null_fd);
+    }
+    body(fds[1]);
+    close(fds[1]);
+    // Skip exit handlers: no final detector report.
+    _exit(0);
+  }
+  close(fds[1]);
+  std::string output;
+  constexpr size_t kBufferSize = 4096;
+  char buffer[kBufferSize];
+  ssize_t bytes = 0;
+  while ((bytes = read(fds[0], buffer, sizeof(buffer))) > 0) {
+    output.append(buffer, static_cast<size_t>(bytes));
+  }
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    return {};
+  }
+  return output;
+}
+}  // namespace bench
@@ -0,0 +1,177 @@
+// nv_detector_bench: hot-path cost of the memory detector's allocation
+// hooks, as JSON on stdout.
+//
+//   nv_detector_bench [iterations]
+//
+// Configurations: unhooked (no detector), full (memory detector, stack on
+// every allocation) and sampled_N (stack on 1 in N allocations, see
+// DetectorSetSampling). One op is a malloc/free, new/delete or calloc/free
+// pair, or malloc + growing realloc + free, issued from a given call stack
+// depth, since the unwind cost grows with it. ns_per_op is the best of a few
+// repeats; overhead_ns is relative to the unhooked run of the same case.
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include "bench_common.h"
+#include "detector.h"
+namespace {
+constexpr size_t kDefaultIterations = 20000;
+constexpr int kRepeats = 3;
+constexpr std::array<size_t, 4> kSizes = {16, 256, 4096, 65536};
+constexpr std::array<size_t, 3> kStackDepths = {1, 8, 32};
+struct Config {
+  const char* name;
+  unsigned int sample_period;  // 0: detector not started
+};
+constexpr std::array<Config, 4> kConfigs = {{{"unhooked", 0},
+                                             {"full", 1},
+                                             {"sampled_16", 16},
+                                             {"sampled_256", 256}}};
+enum class Op : uint8_t { kMallocFree, kNewDelete, kCallocFree, kRealloc };
+constexpr std::array<Op, 4> kOps = {Op::kMallocFree, Op::kNewDelete,
+                                    Op::kCallocFree, Op::kRealloc};
+auto OpName(Op op) -> const char* {
+  switch (op) {
+    case Op::kMallocFree:
+      return "malloc_free";
+    case Op::kNewDelete:
+      return "new_delete";
+    case Op::kCallocFree:
+      return "calloc_free";
+    case Op::kRealloc:
+      return "malloc_realloc_free";
+  }
+  return "?";
+}
+auto RunOp(Op op, size_t size) -> void {
+  switch (op) {
+    case Op::kMallocFree: {
+      void* ptr = malloc(size);
+      bench::DoNotOptimize(ptr);
+      free(ptr);
+      break;
+    }
+    case Op::kNewDelete: {
+      void* ptr = ::operator new(size);
+      bench::DoNotOptimize(ptr);
+      ::operator delete(ptr);
+      break;
+    }
+    case Op::kCallocFree: {
+      void* ptr = calloc(1, size);
+      bench::DoNotOptimize(ptr);
+      free(ptr);
+      break;
+    }
+    case Op::kRealloc: {
+      void* ptr = malloc(size / 2);
+      bench::DoNotOptimize(ptr);
+      ptr = realloc(ptr, size);
+      bench::DoNotOptimize(ptr);
+      free(ptr);
+      break;
+    }
+  }
+}
+auto TimeOp(Op op, size_t size, size_t iterations) -> double {
+  double best = std::numeric_limits<double>::max();
+  for (int repeat = 0; repeat < kRepeats; ++repeat) {
+    uint64_t start = bench::NowNs();
+    for (size_t i = 0; i < iterations; ++i) {
+      RunOp(op, size);
+    }
+    uint64_t elapsed = bench::NowNs() - start;
+    best = std::min(best, static_cast<double>(elapsed) /
+                              static_cast<double>(iterations));
+  }
+  return best;
+}
+// Runs `body` under `depth` extra frames.
+__attribute__((noinline)) auto AtDepth(size_t depth,
+                                       const std::function<double()>& body)
+    -> double {
+  if (depth <= 1) {
+    return body();
+  }
+  double result = AtDepth(depth - 1, body);
+  // No tail call: the frame must stay on the stack.
+  bench::DoNotOptimize(&result);
+  return result;
+}
+auto RunConfig(const Config& config, size_t iterations, int out_fd) -> void {
+  if (config.sample_period != 0) {
+    DetectorInit(".", kDetectorOptionMemory, kOutputOptionConsole);
+    DetectorSetSampling(config.sample_period, 1);
+    DetectorRegisterMain();
+    DetectorStart();
+  }
+  for (Op op : kOps) {
+    for (size_t size : kSizes) {
+      for (size_t depth : kStackDepths) {
+        double ns =
+            AtDepth(depth, [&] { return TimeOp(op, size, iterations); });
+        dprintf(out_fd, "%d %zu %zu %.3f\n", static_cast<int>(op), size,
+                depth, ns);
+      }
+    }
+  }
+}
+using CaseKey = std::tuple<int, size_t, size_t>;
+auto ParseResults(const std::string& output) -> std::map<CaseKey, double> {
+  std::map<CaseKey, double> results;
+  std::istringstream stream(output);
+  int op = 0;
+  size_t size = 0;
+  size_t depth = 0;
+  double ns = 0.0;
+  while (stream >> op >> size >> depth >> ns) {
+    results[{op, size, depth}] = ns;
+  }
+  return results;
+}
+}  // namespace
+auto main(int argc, char** argv) -> int {
+  size_t iterations = kDefaultIterations;
+  if (argc > 1) {
+    iterations = std::max<size_t>(strtoul(argv[1], nullptr, 10), 1);
+  }
+  std::map<std::string, std::map<CaseKey, double>> results;
+  for (const auto& config : kConfigs) {
+    std::string output = bench::RunInChild(
+        [&](int out_fd) { RunConfig(config, iterations, out_fd); });
+    if (output.empty()) {
+      fprintf(stderr, "configuration %s failed\n", config.name);
+      return 1;
+    }
+    results[config.name] = ParseResults(output);
+  }
+  const auto& baseline = results["unhooked"];
+  printf("{\n  \"benchmark\": \"nv_detector_bench\",\n");
+  printf("  \"iterations\": %zu,\n  \"repeats\": %d,\n", iterations, kRepeats);
+  printf("  \"results\": [");
+  bool first = true;
+  for (const auto& config : kConfigs) {
+    for (const auto& [key, ns] : results[config.name]) {
+      const auto& [op, size, depth] = key;
+      auto base = baseline.find(key);
+      double overhead = base != baseline.end() ? ns - base->second : 0.0;
+      printf(
+          "%s\n    {\"config\": \"%s\", \"op\": \"%s\", \"size\": %zu, "
+          "\"stack_depth\": %zu, \"ns_per_op\": %.3f, \"overhead_ns\": %.3f}",
+          first ? "" : ",", config.name, OpName(static_cast<Op>(op)), size,
+          depth, ns, overhead);
+      first = false;
+    }
+  }
+  printf("\n  ]\n}\n");
+  return 0;
+}
@@ -0,0 +1,276 @@
+// nv_detector_lock_bench: cost of the lock detector's pthread_mutex hooks
+// across contention patterns, as JSON on stdout.
+//
+//   nv_detector_lock_bench [ops_per_thread] [threads]
+//
+// Patterns (threads defaults to hardware concurrency, at least 4):
+//   uncontended   1 thread, one mutex
+//   light         2 threads, one mutex, most time spent outside it
+//   heavy         `threads` threads hammering one mutex
+//   nested_chain  2 threads taking a chain of 4 mutexes in order
+//   many_mutexes  `threads` threads, each cycling through its own 4096
+//                 mutexes, so the tracker sees a large lock population
+// One op is a lock/unlock of every mutex it touches. ns_per_op is wall time
+// per op per thread (best of a few repeats); overhead_ns is relative to the
+// unhooked run of the same pattern and throughput_ratio is hooked over
+// unhooked aggregate throughput, so 0.1 means a 10x collapse.
+#include <pthread.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+#include "detector.h"
+namespace {
+constexpr size_t kDefaultOpsPerThread = 50000;
+constexpr size_t kMinDefaultThreads = 4;
+constexpr int kRepeats = 3;
+constexpr size_t kChainLength = 4;
+constexpr size_t kMutexesPerThread = 4096;
+// Spin iterations outside the lock in the light pattern.
+constexpr size_t kLightWork = 200;
+struct Config {
+  const char* name;
+  bool hooked;
+};
+constexpr std::array<Config, 2> kConfigs = {{{"unhooked", false},
+                                             {"lock", true}}};
+enum class Pattern : uint8_t {
+  kUncontended,
+  kLight,
+  kHeavy,
+  kNestedChain,
+  kManyMutexes
+};
+constexpr std::array<Pattern, 5> kPatterns = {
+    Pattern::kUncontended, Pattern::kLight, Pattern::kHeavy,
+    Pattern::kNestedChain, Pattern::kManyMutexes};
+auto PatternName(Pattern pattern) -> const char* {
+  switch (pattern) {
+    case Pattern::kUncontended:
+      return "uncontended";
+    case Pattern::kLight:
+      return "light";
+    case Pattern::kHeavy:
+      return "heavy";
+    case Pattern::kNestedChain:
+      return "nested_chain";
+    case Pattern::kManyMutexes:
+      return "many_mutexes";
+  }
+  return "?";
+}
+auto PatternThreads(Pattern pattern, size_t threads) -> size_t {
+  switch (pattern) {
+    case Pattern::kUncontended:
+      return 1;
+    case Pattern::kLight:
+    case Pattern::kNestedChain:
+      return 2;
+    case Pattern::kHeavy:
+    case Pattern::kManyMutexes:
+      return threads;
+  }
+  return 1;
+}
+auto Spin(size_t iterations) -> void {
+  for (size_t i = 0; i < iterations; ++i) {
+    bench::DoNotOptimize(i);
+  }
+}
+// Mutexes shared by one run. pthread_mutex_t must not move, hence the
+// fixed-size vectors built up front.
+struct Mutexes {
+  std::vector<pthread_mutex_t> chain;
+  std::vector<pthread_mutex_t> per_thread;
+  explicit Mutexes(size_t threads)
+      : chain(kChainLength), per_thread(threads * kMutexesPerThread) {
+    for (auto& mutex : chain) {
+      pthread_mutex_init(&mutex, nullptr);
+    }
+    for (auto& mutex : per_thread) {
+      pthread_mutex_init(&mutex, nullptr);
+    }
+  }
+  ~Mutexes() {
+    for (auto& mutex : chain) {
+      pthread_mutex_destroy(&mutex);
+    }
+    for (auto& mutex : per_thread) {
+      pthread_mutex_destroy(&mutex);
+    }
+  }
+  Mutexes(const Mutexes&) = delete;
+  auto operator=(const Mutexes&) -> Mutexes& = delete;
+};
+auto RunWorker(Pattern pattern, Mutexes& mutexes, size_t index, size_t ops)
+    -> void {
+  pthread_mutex_t* shared = &mutexes.chain[0];
+  for (size_t i = 0; i < ops; ++i) {
+    switch (pattern) {
+      case Pattern::kUncontended:
+      case Pattern::kHeavy:
+        pthread_mutex_lock(shared);
+        pthread_mutex_unlock(shared);
+        break;
+      case Pattern::kLight:
+        pthread_mutex_lock(shared);
+        pthread_mutex_unlock(shared);
+        Spin(kLightWork);
+        break;
+      case Pattern::kNestedChain:
+        for (auto& mutex : mutexes.chain) {
+          pthread_mutex_lock(&mutex);
+        }
+        for (auto it = mutexes.chain.rbegin(); it != mutexes.chain.rend();
+             ++it) {
+          pthread_mutex_unlock(&*it);
+        }
+        break;
+      case Pattern::kManyMutexes: {
+        pthread_mutex_t* mutex =
+            &mutexes.per_thread[index * kMutexesPerThread +
+                                i % kMutexesPerThread];
+        pthread_mutex_lock(mutex);
+        pthread_mutex_unlock(mutex);
+        break;
+      }
+    }
+  }
+}
+// Wall time of one run of `pattern` on `threads` threads.
+auto RunPattern(Pattern pattern, size_t threads, size_t ops) -> uint64_t {
+  Mutexes mutexes(threads);
+  std::atomic<size_t> ready = 0;
+  std::atomic<bool> go = false;
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] {
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      RunWorker(pattern, mutexes, i, ops);
+    });
+  }
+  while (ready.load() != threads) {
+    std::this_thread::yield();
+  }
+  uint64_t start = bench::NowNs();
+  go.store(true, std::memory_order_release);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return bench::NowNs() - start;
+}
+auto RunConfig(const Config& config, size_t ops, size_t threads, int out_fd)
+    -> void {
+  if (config.hooked) {
+    DetectorInit(".", kDetectorOptionLock, kOutputOptionConsole);
+    DetectorRegisterMain();
+    DetectorStart();
+  }
+  for (Pattern pattern : kPatterns) {
+    size_t pattern_threads = PatternThreads(pattern, threads);
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    NvLockStats before{};
+    NvLockStats after{};
+    DetectorGetLockStats(&before);
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+      best = std::min(best, RunPattern(pattern, pattern_threads, ops));
+    }
+    DetectorGetLockStats(&after);
+    size_t acquisitions = after.acquisitions - before.acquisitions;
+    size_t contended =
+        after.contended_acquisitions - before.contended_acquisitions;
+    dprintf(out_fd, "%d %zu %lu %.4f\n", static_cast<int>(pattern),
+            pattern_threads, static_cast<unsigned long>(best),
+            acquisitions == 0 ? 0.0
+                              : static_cast<double>(contended) /
+                                    static_cast<double>(acquisitions));
+  }
+}
+struct Result {
+  size_t threads = 0;
+  uint64_t elapsed_ns = 0;
+  double contended_ratio = 0.0;
+};
+auto ParseResults(const std::string& output) -> std::map<int, Result> {
+  std::map<int, Result> results;
+  std::istringstream stream(output);
+  int pattern = 0;
+  Result result;
+  while (stream >> pattern >> result.threads >> result.elapsed_ns >>
+         result.contended_ratio) {
+    results[pattern] = result;
+  }
+  return results;
+}
+}  // namespace
+auto main(int argc, char** argv) -> int {
+  size_t ops = kDefaultOpsPerThread;
+  size_t threads =
+      std::max<size_t>(std::thread::hardware_concurrency(), kMinDefaultThreads);
+  if (argc > 1) {
+    ops = std::max<size_t>(strtoul(argv[1], nullptr, 10), 1);
+  }
+  if (argc > 2) {
+    threads = std::max<size_t>(strtoul(argv[2], nullptr, 10), 1);
+  }
+  std::map<std::string, std::map<int, Result>> results;
+  for (const auto& config : kConfigs) {
+    std::string output = bench::RunInChild(
+        [&](int out_fd) { RunConfig(config, ops, threads, out_fd); });
+    if (output.empty()) {
+      fprintf(stderr, "configuration %s failed\n", config.name);
+      return 1;
+    }
+    results[config.name] = ParseResults(output);
+  }
+  const auto& baseline = results["unhooked"];
+  printf("{\n  \"benchmark\": \"nv_detector_lock_bench\",\n");
+  printf("  \"ops_per_thread\": %zu,\n  \"repeats\": %d,\n", ops, kRepeats);
+  printf("  \"results\": [");
+  bool first = true;
+  for (const auto& config : kConfigs) {
+    for (const auto& [pattern, result] : results[config.name]) {
+      double ns_per_op =
+          static_cast<double>(result.elapsed_ns) / static_cast<double>(ops);
+      double ops_per_sec =
+          result.elapsed_ns == 0
+              ? 0.0
+              : static_cast<double>(ops * result.threads) * 1e9 /
+                    static_cast<double>(result.elapsed_ns);
+      double overhead = 0.0;
+      double throughput_ratio = 1.0;
+      if (auto base = baseline.find(pattern);
+          base != baseline.end() && result.elapsed_ns != 0) {
+        overhead = ns_per_op - static_cast<double>(base->second.elapsed_ns) /
+                                   static_cast<double>(ops);
+        throughput_ratio = static_cast<double>(base->second.elapsed_ns) /
+                           static_cast<double>(result.elapsed_ns);
+      }
+      printf(
+          "%s\n    {\"config\": \"%s\", \"pattern\": \"%s\", \"threads\": %zu, "
+          "\"ns_per_op\": %.3f, \"overhead_ns\": %.3f, \"ops_per_sec\": %.0f, "
+          "\"throughput_ratio\": %.4f, \"contended_ratio\": %.4f}",
+          first ? "" : ",", config.name,
+          PatternName(static_cast<Pattern>(pattern)), result.threads,
+          ns_per_op, overhead, ops_per_sec, throughput_ratio,
+          result.contended_ratio);
+      first = false;
+    }
+  }
+  printf("\n  ]\n}\n");
+  return 0;
+}
@@ -0,0 +1,287 @@
+// nv_detector_scaling_bench: multi-threaded throughput of allocation-heavy
+// code with and without the memory detector, as JSON on stdout.
+//
+//   nv_detector_scaling_bench [ops_per_thread] [max_threads]
+//
+// Thread counts run from 1 to max_threads (default: hardware concurrency,
+// at least 4) in powers of two. Patterns:
+//   thread_local       each thread frees what it allocated
+//   producer_consumer  thread i allocates, thread i+1 (mod n) frees
+//   shared_pool        threads swap blocks in and out of one shared pool,
+//                      freeing whatever another thread left there
+// ops_per_sec is the aggregate malloc/free pairs per second. table_ns_per_op
+// is the time the hooks spend in MemoryTracker's shared table, lock wait
+// included; lock_wait_ns_per_op is how much that grew over the 1-thread run
+// of the same pattern, i.e. the cost of contention on the tracker lock.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "bench_common.h"
+#include "detector.h"
+namespace {
+constexpr size_t kDefaultOpsPerThread = 20000;
+constexpr size_t kMinDefaultThreads = 4;
+constexpr size_t kBlockSize = 64;
+constexpr size_t kRingSize = 256;
+constexpr size_t kPoolSize = 1024;
+constexpr size_t kCacheLine = 64;
+struct Config {
+  const char* name;
+  bool hooked;
+};
+constexpr std::array<Config, 2> kConfigs = {{{"unhooked", false},
+                                             {"memory", true}}};
+enum class Pattern : uint8_t { kThreadLocal, kProducerConsumer, kSharedPool };
+constexpr std::array<Pattern, 3> kPatterns = {
+    Pattern::kThreadLocal, Pattern::kProducerConsumer, Pattern::kSharedPool};
+auto PatternName(Pattern pattern) -> const char* {
+  switch (pattern) {
+    case Pattern::kThreadLocal:
+      return "thread_local";
+    case Pattern::kProducerConsumer:
+      return "producer_consumer";
+    case Pattern::kSharedPool:
+      return "shared_pool";
+  }
+  return "?";
+}
+// Single-producer single-consumer ring between neighbouring threads.
+struct alignas(kCacheLine) Ring {
+  std::array<void*, kRingSize> slots{};
+  alignas(kCacheLine) std::atomic<size_t> head = 0;  // next push
+  alignas(kCacheLine) std::atomic<size_t> tail = 0;  // next pop
+  auto TryPush(void* ptr) -> bool {
+    size_t at = head.load(std::memory_order_relaxed);
+    if (at - tail.load(std::memory_order_acquire) == kRingSize) {
+      return false;
+    }
+    slots[at % kRingSize] = ptr;
+    head.store(at + 1, std::memory_order_release);
+    return true;
+  }
+  auto TryPop() -> void* {
+    size_t at = tail.load(std::memory_order_relaxed);
+    if (at == head.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    void* ptr = slots[at % kRingSize];
+    tail.store(at + 1, std::memory_order_release);
+    return ptr;
+  }
+};
+auto RunThreadLocal(size_t ops) -> void {
+  for (size_t i = 0; i < ops; ++i) {
+    void* ptr = malloc(kBlockSize);
+    bench::DoNotOptimize(ptr);
+    free(ptr);
+  }
+}
+// Every thread is the producer of its outbound ring and the consumer of its
+// inbound one, so all threads both allocate and free, just never the same
+// block.
+auto RunProducerConsumer(Ring& out, Ring& in, size_t ops) -> void {
+  size_t produced = 0;
+  size_t consumed = 0;
+  void* pending = nullptr;
+  while (produced < ops || consumed < ops) {
+    bool progress = false;
+    if (produced < ops) {
+      if (pending == nullptr) {
+        pending = malloc(kBlockSize);
+      }
+      if (out.TryPush(pending)) {
+        pending = nullptr;
+        ++produced;
+        progress = true;
+      }
+    }
+    if (void* ptr = in.TryPop(); ptr != nullptr) {
+      free(ptr);
+      ++consumed;
+      progress = true;
+    }
+    if (!progress) {
+      // Full outbound and empty inbound ring: let the neighbours run.
+      std::this_thread::yield();
+    }
+  }
+}
+auto RunSharedPool(std::vector<std::atomic<void*>>& pool, size_t seed,
+                   size_t ops) -> void {
+  // xorshift: cheap and allocation-free.
+  uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+  for (size_t i = 0; i < ops; ++i) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    void* ptr = malloc(kBlockSize);
+    void* old =
+        pool[state % kPoolSize].exchange(ptr, std::memory_order_acq_rel);
+    free(old);
+  }
+}
+// Runs one pattern on `threads` threads and returns the elapsed time of the
+// timed section.
+auto RunPattern(Pattern pattern, size_t threads, size_t ops) -> uint64_t {
+  std::vector<std::unique_ptr<Ring>> rings;
+  for (size_t i = 0; i < threads; ++i) {
+    rings.push_back(std::make_unique<Ring>());
+  }
+  std::vector<std::atomic<void*>> pool(kPoolSize);
+  std::atomic<size_t> ready = 0;
+  std::atomic<bool> go = false;
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] {
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      switch (pattern) {
+        case Pattern::kThreadLocal:
+          RunThreadLocal(ops);
+          break;
+        case Pattern::kProducerConsumer:
+          RunProducerConsumer(*rings[i], *rings[(i + threads - 1) % threads],
+                              ops);
+          break;
+        case Pattern::kSharedPool:
+          RunSharedPool(pool, i, ops);
+          break;
+      }
+    });
+  }
+  while (ready.load() != threads) {
+    std::this_thread::yield();
+  }
+  uint64_t start = bench::NowNs();
+  go.store(true, std::memory_order_release);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  uint64_t elapsed = bench::NowNs() - start;
+  for (auto& slot : pool) {
+    free(slot.load());
+  }
+  return elapsed;
+}
+auto ThreadCounts(size_t max_threads) -> std::vector<size_t> {
+  std::vector<size_t> counts;
+  for (size_t count = 1; count < max_threads; count *= 2) {
+    counts.push_back(count);
+  }
+  counts.push_back(max_threads);
+  return counts;
+}
+auto RunConfig(const Config& config, size_t ops, size_t max_threads,
+               int out_fd) -> void {
+  if (config.hooked) {
+    DetectorInit(".", kDetectorOptionMemory, kOutputOptionConsole);
+    DetectorRegisterMain();
+    DetectorStart();
+  }
+  for (Pattern pattern : kPatterns) {
+    for (size_t threads : ThreadCounts(max_threads)) {
+      NvOverheadStats before{};
+      NvOverheadStats after{};
+      DetectorGetOverheadStats(&before);
+      uint64_t elapsed = RunPattern(pattern, threads, ops);
+      DetectorGetOverheadStats(&after);
+      dprintf(out_fd, "%d %zu %lu %lu %lu\n", static_cast<int>(pattern),
+              threads, static_cast<unsigned long>(elapsed),
+              static_cast<unsigned long>(after.table_ns - before.table_ns),
+              static_cast<unsigned long>(after.overhead_ns -
+                                         before.overhead_ns));
+    }
+  }
+}
+struct Result {
+  uint64_t elapsed_ns = 0;
+  uint64_t table_ns = 0;
+  uint64_t overhead_ns = 0;
+};
+using CaseKey = std::tuple<int, size_t>;
+auto ParseResults(const std::string& output) -> std::map<CaseKey, Result> {
+  std::map<CaseKey, Result> results;
+  std::istringstream stream(output);
+  int pattern = 0;
+  size_t threads = 0;
+  Result result;
+  while (stream >> pattern >> threads >> result.elapsed_ns >>
+         result.table_ns >> result.overhead_ns) {
+    results[{pattern, threads}] = result;
+  }
+  return results;
+}
+}  // namespace
+auto main(int argc, char** argv) -> int {
+  size_t ops = kDefaultOpsPerThread;
+  size_t max_threads =
+      std::max<size_t>(std::thread::hardware_concurrency(), kMinDefaultThreads);
+  if (argc > 1) {
+    ops = std::max<size_t>(strtoul(argv[1], nullptr, 10), 1);
+  }
+  if (argc > 2) {
+    max_threads = std::max<size_t>(strtoul(argv[2], nullptr, 10), 1);
+  }
+  std::map<std::string, std::map<CaseKey, Result>> results;
+  for (const auto& config : kConfigs) {
+    std::string output = bench::RunInChild(
+        [&](int out_fd) { RunConfig(config, ops, max_threads, out_fd); });
+    if (output.empty()) {
+      fprintf(stderr, "configuration %s failed\n", config.name);
+      return 1;
+    }
+    results[config.name] = ParseResults(output);
+  }
+  printf("{\n  \"benchmark\": \"nv_detector_scaling_bench\",\n");
+  printf("  \"ops_per_thread\": %zu,\n  \"max_threads\": %zu,\n", ops,
+         max_threads);
+  printf("  \"results\": [");
+  bool first = true;
+  for (const auto& config : kConfigs) {
+    const auto& config_results = results[config.name];
+    for (const auto& [key, result] : config_results) {
+      const auto& [pattern, threads] = key;
+      double total_ops = static_cast<double>(ops * threads);
+      double ops_per_sec = result.elapsed_ns == 0
+                               ? 0.0
+                               : total_ops * 1e9 /
+                                     static_cast<double>(result.elapsed_ns);
+      double table_per_op = static_cast<double>(result.table_ns) / total_ops;
+      double single_table_per_op = table_per_op;
+      double single_ops_per_sec = ops_per_sec;
+      if (auto single = config_results.find({pattern, 1});
+          single != config_results.end() && single->second.elapsed_ns != 0) {
+        single_table_per_op = static_cast<double>(single->second.table_ns) /
+                              static_cast<double>(ops);
+        single_ops_per_sec = static_cast<double>(ops) * 1e9 /
+                             static_cast<double>(single->second.elapsed_ns);
+      }
+      printf(
+          "%s\n    {\"config\": \"%s\", \"pattern\": \"%s\", \"threads\": %zu, "
+          "\"ops_per_sec\": %.0f, \"speedup\": %.3f, "
+          "\"overhead_ns_per_op\": %.3f, \"table_ns_per_op\": %.3f, "
+          "\"lock_wait_ns_per_op\": %.3f}",
+          first ? "" : ",", config.name,
+          PatternName(static_cast<Pattern>(pattern)), threads, ops_per_sec,
+          single_ops_per_sec == 0.0 ? 0.0 : ops_per_sec / single_ops_per_sec,
+          static_cast<double>(result.overhead_ns) / total_ops, table_per_op,
+          std::max(table_per_op - single_table_per_op, 0.0));
+      first = false;
+    }
+  }
+  printf("\n  ]\n}\n");
+  return 0;
+}
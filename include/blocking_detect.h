@@ -0,0 +1,82 @@
+#pragma once
+#include <sys/types.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.h"
+class BlockingDetectImpl;
+enum class BlockingOp : uint8_t {
+  kPoll,
+  kPpoll,
+  kEpollWait,
+  kEpollPwait,
+  kSelect,
+  kPselect,
+  kNanosleep,
+  kClockNanosleep,
+  kUsleep,
+  kSleep,
+  kAccept,
+  kAccept4,
+  kConnect,
+  kCondWait,
+  kCondTimedwait,
+  kSemWait,
+  kSemTimedwait,
+  kRwlockRdlock,
+  kRwlockWrlock,
+  kWaitpid,
+  kWait,
+  kCount,
+};
+constexpr size_t kBlockingOpCount = static_cast<size_t>(BlockingOp::kCount);
+auto BlockingOpName(BlockingOp op) -> const char*;
+// Lock-free view of the tracker totals; safe to read from a signal handler.
+struct BlockingCounters {
+  size_t calls;
+  uint64_t blocked_ns;
+};
+// Keyed by the return address of the hooked call, i.e. the call site.
+struct BlockingSiteStats {
+  void* site = nullptr;
+  BlockingOp op = BlockingOp::kPoll;
+  size_t calls = 0;
+  uint64_t blocked_ns = 0;
+  uint64_t max_ns = 0;
+  LatencyHistogram latency{};
+};
+struct BlockingThreadStats {
+  pid_t tid = 0;
+  size_t calls = 0;
+  uint64_t blocked_ns = 0;
+  std::array<uint64_t, kBlockingOpCount> blocked_ns_by_op{};
+};
+// Off-CPU profile: wall time threads spend inside blocking libc calls.
+// Mutex waits are covered by the lock detector; together the two account
+// for most of the time a thread is runnable-but-not-running or asleep.
+class BlockingDetect {
+ public:
+  static auto GetInstance() -> BlockingDetect& {
+    static BlockingDetect instance;
+    return instance;
+  }
+  void Register(const std::string& lib_name);
+  void RegisterMain();
+  void Start();
+  void Detect();
+  auto GetCounters() const -> BlockingCounters;
+  // Sites with the most blocked time first.
+  auto GetTopSites(size_t count) const -> std::vector<BlockingSiteStats>;
+  // Threads with the most blocked time first.
+  auto GetTopThreads(size_t count) const -> std::vector<BlockingThreadStats>;
+  void PrintTopSites(size_t count);
+  ~BlockingDetect();
+
+ private:
+  BlockingDetect();
+  std::unique_ptr<BlockingDetectImpl> impl_;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <poll.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+namespace tracker {
+// Line-oriented Unix-domain-socket server. It owns no thread: the detector
+// service adds its descriptors to its poll set and hands back the results.
+class ControlSocket {
+ public:
+  using CommandHandler = std::function<std::string(const std::string&)>;
+  explicit ControlSocket(CommandHandler handler)
+      : handler_(std::move(handler)) {}
+  ~ControlSocket() { Close(); }
+  auto Listen(const std::string& path) -> bool;
+  auto Close() -> void;
+  [[nodiscard]] auto IsListening() const -> bool { return listen_fd_ >= 0; }
+  auto AppendPollFds(std::vector<pollfd>& fds) const -> void;
+  auto HandlePollFds(const pollfd* fds, size_t count) -> void;
+  ControlSocket(const ControlSocket&) = delete;
+  auto operator=(const ControlSocket&) -> ControlSocket& = delete;
+
+ private:
+  struct Client {
+    int fd;
+    std::string input;
+    // Reply bytes the client has not read yet; sent as the socket drains.
+    std::string output;
+  };
+  auto Accept() -> void;
+  auto ServeClient(Client& client) -> bool;
+  static auto Flush(Client& client) -> bool;
+  CommandHandler handler_;
+  std::string path_;
+  int listen_fd_ = -1;
+  std::vector<Client> clients_;
+};
+}  // namespace tracker
@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CopyDetectImpl;
+enum class CopyOp : uint8_t {
+  kMemcpy,
+  kMemmove,
+  kMemset,
+  kStrcpy,
+  kStrlen,
+  kCount,
+};
+constexpr size_t kCopyOpCount = static_cast<size_t>(CopyOp::kCount);
+auto CopyOpName(CopyOp op) -> const char*;
+// Powers of four from <=16 bytes up to <=256 KiB, then everything larger.
+constexpr size_t kCopySizeBucketCount = 9;
+auto CopySizeBucketName(size_t bucket) -> const char*;
+// Lock-free view of the tracker totals; safe to read from a signal handler.
+struct CopyCounters {
+  size_t calls;
+  size_t bytes;
+  // Copies at or above the stack threshold
+  size_t large_copies;
+  // Calls from sites that no longer fit the site table
+  size_t untracked_calls;
+};
+// Keyed by the return address of the hooked call, i.e. the call site.
+struct CopySiteStats {
+  void* site = nullptr;
+  CopyOp op = CopyOp::kMemcpy;
+  size_t calls = 0;
+  size_t bytes = 0;
+  std::array<size_t, kCopySizeBucketCount> sizes{};
+};
+// Copies at or above the stack threshold, keyed by their call stack.
+struct CopyStackStats {
+  CopyOp op = CopyOp::kMemcpy;
+  size_t calls = 0;
+  size_t bytes = 0;
+  size_t max_bytes = 0;
+  std::vector<void*> callstack;
+};
+// Bytes moved by memcpy, memmove, memset, strcpy and strlen from the
+// registered modules. Calls the compiler inlines (small constant sizes) never
+// reach the PLT and are not seen. Every call lands in a fixed lock-free site
+// table; only copies at or above the stack threshold take a lock and unwind.
+class CopyDetect {
+ public:
+  static auto GetInstance() -> CopyDetect& {
+    static CopyDetect instance;
+    return instance;
+  }
+  void Register(const std::string& lib_name);
+  void RegisterMain();
+  void Start();
+  void Detect();
+  auto GetCounters() const -> CopyCounters;
+  void SetStackThreshold(size_t bytes);
+  auto GetStackThreshold() const -> size_t;
+  // Sites with the most bytes first.
+  auto GetTopSites(size_t count) const -> std::vector<CopySiteStats>;
+  // Large-copy stacks with the most bytes first.
+  auto GetTopStacks(size_t count) const -> std::vector<CopyStackStats>;
+  void PrintTopSites(size_t count);
+  ~CopyDetect();
+
+ private:
+  CopyDetect();
+  std::unique_ptr<CopyDetectImpl> impl_;
+};
@@ -1,19 +1,102 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 extern "C" {
 enum DetectorOption {
   kDetectorOptionMemory = 1,
   kDetectorOptionLock = 2,
   kDetectorOptionMemoryLock = 3,
+  kDetectorOptionIo = 4,
+  kDetectorOptionThread = 8,
+  kDetectorOptionBlocking = 16,
+  kDetectorOptionFd = 32,
+  kDetectorOptionCopy = 64,
+  kDetectorOptionException = 128,
+  kDetectorOptionAll = 255,
 };
 enum OutputOption {
   kOutputOptionConsole = 1,
   kOutputOptionFile = 2,
   kOutputOptionConsoleFile = 3,
 };
+struct NvMemStats {
+  size_t total_allocated;
+  size_t total_freed;
+  size_t active_allocations;
+  size_t active_bytes;
+};
+struct NvAllocSite {
+  void* site;
+  size_t bytes;
+  size_t count;
+};
+struct NvLockStats {
+  size_t acquisitions;
+  size_t contended_acquisitions;
+  size_t deadlocks_detected;
+  uint64_t total_wait_ns;
+};
+struct NvLockEntry {
+  void* lock_addr;
+  size_t acquisitions;
+  size_t contended_acquisitions;
+  uint64_t wait_ns;
+  uint64_t max_wait_ns;
+};
+// Cost of the detector itself since DetectorStart. The percentages relate
+// time spent inside hooks (summed over threads) to elapsed wall time and to
+// process CPU time. unwind_ns and table_ns are the parts of overhead_ns spent
+// capturing stacks and updating the trackers' shared tables, the latter
+// including the wait for the table locks.
+struct NvOverheadStats {
+  uint64_t hooked_calls;
+  uint64_t overhead_ns;
+  size_t metadata_bytes;
+  double wall_percent;
+  double cpu_percent;
+  uint64_t unwind_ns;
+  uint64_t table_ns;
+};
 void DetectorInit(const char* work_dir, DetectorOption detect_option,
                   OutputOption output_option);
 void DetectorStart(void);
 void DetectorDetect(void);
 void DetectorRegister(const char* lib_name);
 void DetectorRegisterMain(void);
+void DetectorSetLogRotation(size_t max_file_bytes, size_t max_files);
+void DetectorStartPeriodic(unsigned int interval_ms, DetectorOption flags);
+void DetectorEnableSignalDump(int signal_number);
+void DetectorEnableControlSocket(void);
+void DetectorStartPrometheusExport(unsigned int interval_ms);
+void DetectorStartStatsSegment(unsigned int interval_ms);
+// Stack capture costs most of the hook time. DetectorSetSampling fixes the
+// rate (capture one in N allocations / newly seen locks, 1 = all);
+// DetectorSetOverheadBudget instead adapts both rates at run time to keep
+// the detector under `cpu_percent` of process CPU. Call either right after
+// DetectorInit.
+void DetectorSetSampling(unsigned int memory_period,
+                         unsigned int lock_stack_period);
+void DetectorSetOverheadBudget(double cpu_percent);
+void DetectorStop(void);
+// Times every call to an imported function from the registered modules
+// (x86-64 only). Returns the number of modules now traced; results appear in
+// DetectorDetect.
+size_t DetectorTraceFunction(const char* symbol);
+// Counts calls through every PLT slot of the registered modules (x86-64
+// only). Returns the number of slots counted; the most-called imports of each
+// module appear in DetectorDetect.
+size_t DetectorStartCallCensus(void);
+// memcpy-family calls of at least `bytes` record their call stack in the copy
+// profile (64 KiB by default).
+void DetectorSetCopyStackThreshold(size_t bytes);
+// Counters are read lock-free; the top-N queries work on a snapshot and
+// return the number of entries written. Return -1/0 if the detector for
+// that data is not enabled.
+int DetectorGetMemoryStats(struct NvMemStats* stats);
+// Allocations whose stack was not sampled belong to no site and are left
+// out.
+size_t DetectorGetTopSites(struct NvAllocSite* sites, size_t count);
+int DetectorGetLockStats(struct NvLockStats* stats);
+size_t DetectorGetTopLocks(struct NvLockEntry* locks, size_t count);
+int DetectorGetOverheadStats(struct NvOverheadStats* stats);
 }
@@ -0,0 +1,26 @@
+#pragma once
+#include <memory>
+#include <string>
+class DetectorServiceImpl;
+// Owns the detector's background thread. Periodic reports and on-demand
+// dumps are all produced here, never on application threads.
+class DetectorService {
+ public:
+  static auto GetInstance() -> DetectorService& {
+    static DetectorService instance;
+    return instance;
+  }
+  void StartPeriodic(unsigned int interval_ms, int detect_option);
+  void EnableSignalDump(int signal_number, int detect_option);
+  void EnableControlSocket(const std::string& path, int detect_option);
+  void StartPrometheusExport(const std::string& path, unsigned int interval_ms,
+                             int detect_option);
+  void StartStatsSegment(unsigned int interval_ms, int detect_option);
+  void StartGovernor(double budget_percent, int detect_option);
+  void Stop();
+  ~DetectorService();
+
+ private:
+  DetectorService();
+  std::unique_ptr<DetectorServiceImpl> impl_;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.h"
+class ExceptionDetectImpl;
+// Lock-free view of the tracker totals; safe to read from a signal handler.
+struct ExceptionCounters {
+  size_t allocated;
+  size_t allocated_bytes;
+  size_t throws;
+  // Catches matched to a throw seen by the detector
+  size_t caught;
+  uint64_t throw_to_catch_ns;
+};
+// Keyed by throw site (return address of the __cxa_throw call) and thrown
+// type.
+struct ExceptionSiteStats {
+  void* site = nullptr;
+  std::string type;
+  size_t throws = 0;
+  size_t caught = 0;
+  // Lifetime average, and the most throws within any one-second window;
+  // the latter stays 0 until the site has been watched for a full second.
+  double throws_per_second = 0.0;
+  size_t peak_throws_per_second = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  LatencyHistogram latency{};
+};
+// Cost of C++ exceptions thrown and caught in the registered modules: throws
+// per site and type, and the time from __cxa_throw to the matching
+// __cxa_begin_catch (the unwind). Catches in modules that are not registered
+// are not matched, so caught can be lower than throws.
+class ExceptionDetect {
+ public:
+  static auto GetInstance() -> ExceptionDetect& {
+    static ExceptionDetect instance;
+    return instance;
+  }
+  void Register(const std::string& lib_name);
+  void RegisterMain();
+  void Start();
+  void Detect();
+  auto GetCounters() const -> ExceptionCounters;
+  // Sites with the most throws first.
+  auto GetTopSites(size_t count) const -> std::vector<ExceptionSiteStats>;
+  void PrintTopSites(size_t count);
+  ~ExceptionDetect();
+
+ private:
+  ExceptionDetect();
+  std::unique_ptr<ExceptionDetectImpl> impl_;
+};
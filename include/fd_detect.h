@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FdDetectImpl;
+enum class FdKind : uint8_t {
+  kNone,
+  kFile,
+  kSocket,
+  kPipe,
+  kDup,
+  kEventfd,
+  kEpoll,
+};
+auto FdKindName(FdKind kind) -> const char*;
+// Lock-free view of the tracker totals; safe to read from a signal handler.
+struct FdCounters {
+  size_t opened;
+  size_t closed;
+  size_t open;
+  size_t peak_open;
+  // close() of descriptors opened before Start or outside registered modules
+  size_t untracked_closes;
+  // Descriptors at or above the table size (the RLIMIT_NOFILE soft limit)
+  size_t overflow;
+  size_t limit;
+};
+// Open descriptors grouped by the return address of the call that created
+// them.
+struct FdSiteStats {
+  void* site = nullptr;
+  FdKind kind = FdKind::kNone;
+  size_t open = 0;
+  uint32_t oldest_age_s = 0;
+  std::vector<int> sample_fds;
+};
+// Open descriptors live in a flat fd-indexed table of atomic slots sized to
+// the descriptor limit, so open and close cost one atomic store each; the
+// table is only walked when reporting. The slot records the creating call
+// site. Descriptors closed by code the detector does not see (fclose after
+// fdopen, unregistered modules) are weeded out with F_GETFD at report time.
+class FdDetect {
+ public:
+  static auto GetInstance() -> FdDetect& {
+    static FdDetect instance;
+    return instance;
+  }
+  void Register(const std::string& lib_name);
+  void RegisterMain();
+  void Start();
+  void Detect();
+  auto GetCounters() const -> FdCounters;
+  // Sites holding the most open descriptors first.
+  auto GetOpenSites(size_t count) const -> std::vector<FdSiteStats>;
+  void PrintOpenSites(size_t count);
+  ~FdDetect();
+
+ private:
+  FdDetect();
+  std::unique_ptr<FdDetectImpl> impl_;
+};
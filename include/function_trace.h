@@ -0,0 +1,60 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.h"
+class FunctionTraceImpl;
+struct TracedFunctionStats {
+  std::string symbol;
+  size_t modules = 0;
+  size_t calls = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  LatencyHistogram latency{};
+};
+struct ImportCallCount {
+  std::string module;  // empty for the main executable
+  std::string symbol;
+  uint64_t calls = 0;
+};
+// Times any imported function without a hand-written hook. Each traced PLT
+// slot is pointed at a generated x86-64 trampoline that keeps the caller's
+// return address on a per-thread shadow stack, calls the original with all
+// argument registers and stack arguments untouched, and records the latency
+// on the way back.
+//
+// Limitations: exceptions and longjmp must not unwind through a traced
+// call, and x87 (long double) return values are not preserved. Trampolines
+// carry no unwind info, so a backtrace taken inside a traced call (e.g. the
+// memory detector's allocation stacks) stops at the trampoline.
+//
+// The call census is the cheap first pass: every PLT slot of the registered
+// modules is pointed at a counting stub that bumps the slot's counter and
+// jumps on, without touching the stack. It answers which library calls
+// dominate before choosing what to trace.
+class FunctionTrace {
+ public:
+  static auto GetInstance() -> FunctionTrace& {
+    static FunctionTrace instance;
+    return instance;
+  }
+  void Register(const std::string& lib_name);
+  void RegisterMain();
+  // Returns the number of registered modules now routed through the
+  // trampoline; 0 if the symbol is not imported anywhere or tracing is not
+  // supported on this architecture.
+  auto TraceFunction(const std::string& symbol) -> size_t;
+  auto GetStats() const -> std::vector<TracedFunctionStats>;
+  // Returns the number of PLT slots now counted.
+  auto StartCensus() -> size_t;
+  // Most-called imports first.
+  auto GetCensus(size_t count) const -> std::vector<ImportCallCount>;
+  void PrintCensus(size_t count);
+  void Detect();
+  ~FunctionTrace();
+
+ private:
+  FunctionTrace();
+  std::unique_ptr<FunctionTraceImpl> impl_;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.h"
+class IoDetectImpl;
+enum class IoOp : uint8_t {
+  kRead,
+  kWrite,
+  kPread,
+  kPwrite,
+  kReadv,
+  kWritev,
+  kFsync,
+  kFdatasync,
+  kSend,
+  kRecv,
+  kSendmsg,
+  kRecvmsg,
+  kCount,
+};
+constexpr size_t kIoOpCount = static_cast<size_t>(IoOp::kCount);
+auto IoOpName(IoOp op) -> const char*;
+// Lock-free view of the tracker totals; safe to read from a signal handler.
+struct IoCounters {
+  size_t calls;
+  size_t bytes_read;
+  size_t bytes_written;
+  size_t errors;
+  uint64_t total_ns;
+};
+// Keyed by the return address of the hooked call, i.e. the call site.
+struct IoSiteStats {
+  void* site = nullptr;
+  IoOp op = IoOp::kRead;
+  size_t calls = 0;
+  size_t bytes = 0;
+  size_t errors = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  LatencyHistogram latency{};
+};
+struct IoFdStats {
+  int fd = -1;
+  size_t calls = 0;
+  size_t bytes_read = 0;
+  size_t bytes_written = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  LatencyHistogram latency{};
+};
+// Data calls on one connection. The peer is looked up when the descriptor is
+// first seen and again whenever its number is reused for another socket;
+// stats of the replaced connection are kept (up to 64 of them).
+struct IoSocketStats {
+  int fd = -1;
+  std::string peer;
+  size_t writes = 0;
+  size_t bytes_written = 0;
+  // Writes below kIoTinyWriteBytes: each costs a syscall and, without
+  // TCP_CORK or MSG_MORE, usually a packet of its own.
+  size_t tiny_writes = 0;
+  size_t reads = 0;
+  size_t bytes_read = 0;
+};
+constexpr size_t kIoTinyWriteBytes = 256;
+class IoDetect {
+ public:
+  static auto GetInstance() -> IoDetect& {
+    static IoDetect instance;
+    return instance;
+  }
+  void Register(const std::string& lib_name);
+  void RegisterMain();
+  void Start();
+  void Detect();
+  auto GetCounters() const -> IoCounters;
+  // Sites with the worst p99 latency first.
+  auto GetSlowestSites(size_t count) const -> std::vector<IoSiteStats>;
+  // Descriptors with the most time spent in I/O first.
+  auto GetBusiestFds(size_t count) const -> std::vector<IoFdStats>;
+  // Sockets with the most bytes moved first.
+  auto GetBusiestSockets(size_t count) const -> std::vector<IoSocketStats>;
+  void PrintSlowestSites(size_t count);
+  ~IoDetect();
+
+ private:
+  IoDetect();
+  std::unique_ptr<IoDetectImpl> impl_;
+};
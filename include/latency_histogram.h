@@ -0,0 +1,17 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+// Call latencies bucketed by power of two: bucket i holds calls that took
+// less than 2^i ns, the last bucket everything slower.
+constexpr size_t kLatencyBuckets = 36;
+using LatencyHistogram = std::array<uint64_t, kLatencyBuckets>;
+inline auto LatencyBucket(uint64_t latency_ns) -> size_t {
+  return std::min<size_t>(std::bit_width(latency_ns), kLatencyBuckets - 1);
+}
+// Upper bound of the bucket containing the given fraction of calls, clamped
+// to max_ns: a bucket bound can overshoot the slowest call actually seen.
+auto LatencyPercentile(const LatencyHistogram& histogram, double fraction,
+                       uint64_t max_ns) -> uint64_t;
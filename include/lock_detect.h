@@ -1,7 +1,31 @@
 #pragma once
+#include <sys/types.h>
+
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 class LockDetectImpl;
+// Lock-free view of the tracker totals; safe to read from a signal handler.
+struct LockCounters {
+  size_t acquisitions;
+  size_t contended_acquisitions;
+  size_t deadlocks_detected;
+  uint64_t total_wait_ns;
+};
+struct LockStats {
+  void* lock_addr = nullptr;
+  size_t acquisitions = 0;
+  size_t contended_acquisitions = 0;
+  uint64_t wait_ns = 0;
+  uint64_t max_wait_ns = 0;
+};
+struct ThreadWaitStats {
+  pid_t tid = 0;
+  size_t acquisitions = 0;
+  size_t contended_acquisitions = 0;
+  uint64_t wait_ns = 0;
+};
 class LockDetect {
  public:
   static auto GetInstance() -> LockDetect& {
@@ -12,6 +36,17 @@ class LockDetect {
   void RegisterMain();
   void Start();
   void Detect();
+  void DetectIncremental();
+  auto GetCounters() const -> LockCounters;
+  auto GetLockStats(size_t count) const -> std::vector<LockStats>;
+  auto GetThreadWaitStats(size_t count) const -> std::vector<ThreadWaitStats>;
+  auto GetMetadataBytes() const -> size_t;
+  // Capture a call stack for one in `period` newly seen locks (1 = all).
+  void SetStackSamplePeriod(uint32_t period);
+  auto GetStackSamplePeriod() const -> uint32_t;
+  void PrintContention(size_t count);
+  void Checkpoint();
+  void PrintDiff();
   ~LockDetect();
 
  private:
@@ -1,7 +1,34 @@
 #pragma once
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 class MemoryDetectImpl;
+// Lock-free view of the tracker totals; safe to read from a signal handler.
+struct MemoryCounters {
+  size_t total_allocated;
+  size_t total_freed;
+  size_t active_allocations;
+  size_t allocation_count;
+  size_t free_count;
+  // Bytes outstanding. Kept as its own counter: total_allocated minus
+  // total_freed from two separate loads can wrap when a free lands in
+  // between.
+  size_t active_bytes;
+};
+// Allocation sizes bucketed by power of two: class i holds sizes up to
+// 16 << i bytes, the last class everything above 1 MiB.
+constexpr size_t kSizeClassCount = 18;
+struct SizeHistogram {
+  std::array<size_t, kSizeClassCount> counts{};
+  size_t sum = 0;
+};
+struct AllocationSite {
+  void* site = nullptr;
+  size_t bytes = 0;
+  size_t count = 0;
+};
 class MemoryDetect {
  public:
   static auto GetInstance() -> MemoryDetect& {
@@ -12,6 +39,17 @@ class MemoryDetect {
   void RegisterMain();
   void Start();
   void Detect();
+  void DetectIncremental();
+  auto GetCounters() const -> MemoryCounters;
+  auto GetSizeHistogram() const -> SizeHistogram;
+  auto GetTopSites(size_t count) const -> std::vector<AllocationSite>;
+  auto GetMetadataBytes() const -> size_t;
+  // Capture a call stack for one in `period` allocations (1 = all).
+  void SetSamplePeriod(uint32_t period);
+  auto GetSamplePeriod() const -> uint32_t;
+  void PrintTopSites(size_t count);
+  void Checkpoint();
+  void PrintDiff();
   ~MemoryDetect();
 
  private:
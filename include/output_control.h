@@ -1,5 +1,8 @@
 #pragma once
+#include <atomic>
 #include <cstdarg>
+#include <cstdio>
+#include <mutex>
 #include <string>
 
 #include "detector.h"
@@ -24,23 +27,68 @@ class OutputControl {
     return instance;
   }
   auto Configure(OutputOption option, const std::string& filename = "") -> void;
+  // Rotate the output file once it exceeds max_file_bytes, keeping at most
+  // max_files files (the active one included). Zero disables rotation.
+  // Rotation only happens between reports, never inside a ReportSection.
+  auto SetRotation(size_t max_file_bytes, size_t max_files) -> void;
   auto Print(const char* format, ...) const -> void;
   auto PrintToFile(const char* format, ...) const -> void;
   auto PrintToConsole(const char* format, ...) const -> void;
-  [[nodiscard]] auto GetOutputFile() const -> FILE* { return output_file_; }
+  // Raw descriptor of the current log file, or -1. Async-signal-safe.
+  // Rotation reopens the log onto the same descriptor, so it stays valid
+  // until the next Configure.
+  [[nodiscard]] auto GetOutputFd() const -> int {
+    return output_fd_.load(std::memory_order_acquire);
+  }
   auto PrintColored(const char* color_start, const char* color_end,
                     const char* format, ...) const -> void;
+  // Everything the calling thread prints between BeginSection and the
+  // matching EndSection is buffered thread-locally and published to each
+  // sink in a single write, so concurrent reports never interleave.
+  auto BeginSection() const -> void;
+  auto EndSection() const -> void;
+  // Redirect everything the calling thread prints into target (uncolored)
+  // instead of the sinks, until EndCapture. Used to answer control queries.
+  auto BeginCapture(std::string* target) const -> void;
+  auto EndCapture() const -> void;
   OutputControl(const OutputControl&) = delete;
   auto operator=(const OutputControl&) -> OutputControl& = delete;
 
  private:
   OutputControl() = default;
   ~OutputControl();
-  auto OpenOutputFile() -> void;
-  auto CloseOutputFile() -> void;
+  auto OpenOutputFile() const -> void;
+  auto CloseOutputFile() const -> void;
+  auto WriteToConsole(const char* color_start, const char* color_end,
+                      const char* format, va_list args) const -> void;
+  auto WriteToFile(const char* format, va_list args) const -> void;
+  auto PublishToFile(const std::string& text) const -> void;
+  auto RotateOutputFile() const -> void;
+  auto RotateIfFull() const -> void;
   OutputOption output_option_ = OutputOption::kOutputOptionConsoleFile;
   std::string output_file_name_;
-  FILE* output_file_ = nullptr;
+  size_t max_file_bytes_ = 0;
+  size_t max_files_ = 0;
+  mutable std::mutex file_mutex_;
+  mutable FILE* output_file_ = nullptr;
+  mutable size_t file_bytes_ = 0;
+  mutable std::atomic<int> output_fd_ = -1;
+};
+class ReportSection {
+ public:
+  ReportSection() { OutputControl::Instance().BeginSection(); }
+  ~ReportSection() { OutputControl::Instance().EndSection(); }
+  ReportSection(const ReportSection&) = delete;
+  auto operator=(const ReportSection&) -> ReportSection& = delete;
+};
+class ReportCapture {
+ public:
+  explicit ReportCapture(std::string* target) {
+    OutputControl::Instance().BeginCapture(target);
+  }
+  ~ReportCapture() { OutputControl::Instance().EndCapture(); }
+  ReportCapture(const ReportCapture&) = delete;
+  auto operator=(const ReportCapture&) -> ReportCapture& = delete;
 };
 }  // namespace tracker
 #define TRACKER_PRINT(...) tracker::OutputControl::Instance().Print(__VA_ARGS__)
@@ -0,0 +1,228 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+// Cost of the detector itself. Every hook wraps its bookkeeping in a
+// HookScope (total time outside the real libc call) and the expensive steps
+// inside it in PhaseScopes, so the split can be reported per hook type.
+// Phases may nest: the stack captured for a new lock is counted both as
+// unwind and as lock bookkeeping.
+namespace tracker {
+enum class HookKind : uint8_t {
+  kMalloc,
+  kFree,
+  kCalloc,
+  kRealloc,
+  kOperatorNew,
+  kOperatorDelete,
+  kOperatorNewArray,
+  kOperatorDeleteArray,
+  kLibcAllocation,
+  kMutexLock,
+  kMutexUnlock,
+  kMutexTrylock,
+  kMutexDestroy,
+  kRead,
+  kWrite,
+  kPread,
+  kPwrite,
+  kReadv,
+  kWritev,
+  kFsync,
+  kFdatasync,
+  kSend,
+  kRecv,
+  kSendmsg,
+  kRecvmsg,
+  kPthreadCreate,
+  kPthreadJoin,
+  kPthreadDetach,
+  kPthreadExit,
+  // In BlockingOp order.
+  kPoll,
+  kPpoll,
+  kEpollWait,
+  kEpollPwait,
+  kSelect,
+  kPselect,
+  kNanosleep,
+  kClockNanosleep,
+  kUsleep,
+  kSleep,
+  kAccept,
+  kAccept4,
+  kConnect,
+  kCondWait,
+  kCondTimedwait,
+  kSemWait,
+  kSemTimedwait,
+  kRwlockRdlock,
+  kRwlockWrlock,
+  kWaitpid,
+  kWait,
+  kFdOpen,
+  kFdClose,
+  kMemcpy,
+  kMemmove,
+  kMemset,
+  kStrcpy,
+  kStrlen,
+  kCxaAllocateException,
+  kCxaThrow,
+  kCxaBeginCatch,
+  kCount,
+};
+enum class OverheadPhase : uint8_t {
+  kRecord,  // everything the hook does besides the real call
+  kUnwind,
+  kTable,
+  kLockBookkeeping,
+  kCount,
+};
+constexpr size_t kHookKindCount = static_cast<size_t>(HookKind::kCount);
+constexpr size_t kOverheadPhaseCount =
+    static_cast<size_t>(OverheadPhase::kCount);
+struct OverheadCounters {
+  std::array<uint64_t, kHookKindCount> calls{};
+  std::array<std::array<uint64_t, kOverheadPhaseCount>, kHookKindCount>
+      cycles{};
+  uint64_t hooked_calls = 0;
+  uint64_t overhead_ns = 0;
+  uint64_t unwind_ns = 0;
+  uint64_t table_ns = 0;
+  uint64_t wall_ns = 0;
+  uint64_t cpu_ns = 0;
+  size_t metadata_bytes = 0;
+  double wall_percent = 0.0;
+  double cpu_percent = 0.0;
+};
+auto HookKindName(HookKind kind) -> const char*;
+// TSC where available; the rate is calibrated against steady_clock between
+// OverheadAccounting::Start and the time the counters are read.
+inline auto ReadCycles() -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+class OverheadAccounting {
+ public:
+  static auto Instance() -> OverheadAccounting&;
+  // Sets the wall/CPU baseline; later calls are no-ops.
+  auto Start() -> void;
+  auto CountCall(HookKind kind) -> void;
+  auto AddCycles(HookKind kind, OverheadPhase phase, uint64_t cycles) -> void;
+  auto GetCounters(int detect_option) const -> OverheadCounters;
+  auto Print(int detect_option) const -> void;
+  OverheadAccounting(const OverheadAccounting&) = delete;
+  auto operator=(const OverheadAccounting&) -> OverheadAccounting& = delete;
+
+ private:
+  OverheadAccounting() = default;
+};
+// Feedback loop that keeps the detector's share of process CPU near a
+// budget by trading stack-capture rate for cost: the sampling period is
+// raised while over budget and relaxed again once well under it. Driven
+// from the service thread.
+class OverheadGovernor {
+ public:
+  OverheadGovernor(double budget_percent, int detect_option)
+      : budget_percent_(budget_percent), detect_option_(detect_option) {}
+  auto Update() -> void;
+
+ private:
+  auto Apply(uint32_t period) -> void;
+  double budget_percent_;
+  int detect_option_;
+  uint32_t period_ = 1;
+  uint64_t last_overhead_ns_ = 0;
+  uint64_t last_cpu_ns_ = 0;
+};
+// Set while a hook or a function-trace trampoline forwards to another
+// detector's hook for the same symbol, so the inner hook reports the
+// application's call site instead of its own return address, which points
+// into the outer hook or trampoline.
+inline thread_local void* forwarded_site = nullptr;
+inline auto CallSite(void* return_address) -> void* {
+  return forwarded_site != nullptr ? forwarded_site : return_address;
+}
+class ForwardedCall {
+ public:
+  explicit ForwardedCall(void* site) : outer_(forwarded_site) {
+    forwarded_site = site;
+  }
+  ~ForwardedCall() { forwarded_site = outer_; }
+  ForwardedCall(const ForwardedCall&) = delete;
+  auto operator=(const ForwardedCall&) -> ForwardedCall& = delete;
+
+ private:
+  void* outer_;
+};
+// Bumped before a descriptor number is closed or overwritten by whichever
+// detector's close/dup2/dup3 hook owns the slot, so per-descriptor caches
+// can tell a reused number apart without a syscall. Numbers share slots
+// modulo the table size, which at worst costs a spurious re-probe. Closes
+// in modules without those hooks go unseen.
+constexpr size_t kFdGenerationSlots = 4096;
+inline std::array<std::atomic<uint32_t>, kFdGenerationSlots> fd_generations{};
+inline auto FdGeneration(int fd) -> uint32_t {
+  return fd_generations[static_cast<size_t>(fd) % kFdGenerationSlots].load(
+      std::memory_order_acquire);
+}
+inline auto BumpFdGeneration(int fd) -> void {
+  if (fd >= 0) {
+    fd_generations[static_cast<size_t>(fd) % kFdGenerationSlots].fetch_add(
+        1, std::memory_order_acq_rel);
+  }
+}
+// The hook a thread is currently inside, so PhaseScopes deeper in the
+// trackers are charged to the right hook type.
+inline thread_local HookKind current_hook = HookKind::kCount;
+class HookScope {
+ public:
+  explicit HookScope(HookKind kind)
+      : kind_(kind), outer_(current_hook), start_(ReadCycles()) {
+    current_hook = kind;
+    OverheadAccounting::Instance().CountCall(kind);
+  }
+  ~HookScope() {
+    OverheadAccounting::Instance().AddCycles(
+        kind_, OverheadPhase::kRecord, ReadCycles() - start_ - excluded_);
+    current_hook = outer_;
+  }
+  // Leaves time spent in the real call inside the scope out of the record.
+  auto Exclude(uint64_t cycles) -> void { excluded_ += cycles; }
+  HookScope(const HookScope&) = delete;
+  auto operator=(const HookScope&) -> HookScope& = delete;
+
+ private:
+  HookKind kind_;
+  HookKind outer_;
+  uint64_t start_;
+  uint64_t excluded_ = 0;
+};
+class PhaseScope {
+ public:
+  explicit PhaseScope(OverheadPhase phase)
+      : phase_(phase), start_(ReadCycles()) {}
+  ~PhaseScope() {
+    if (current_hook != HookKind::kCount) {
+      OverheadAccounting::Instance().AddCycles(current_hook, phase_,
+                                               ReadCycles() - start_);
+    }
+  }
+  PhaseScope(const PhaseScope&) = delete;
+  auto operator=(const PhaseScope&) -> PhaseScope& = delete;
+
+ private:
+  OverheadPhase phase_;
+  uint64_t start_;
+};
+}  // namespace tracker
@@ -0,0 +1,23 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+namespace tracker {
+// Renders detector counters in the Prometheus text exposition format and
+// publishes them for the node-exporter textfile collector.
+class PrometheusExporter {
+ public:
+  explicit PrometheusExporter(int detect_option)
+      : detect_option_(detect_option) {}
+  auto Render() -> std::string;
+  // Writes to a temporary file in the same directory and renames it over
+  // path, so the collector never sees a partial file.
+  auto WriteFile(const std::string& path) -> bool;
+
+ private:
+  int detect_option_;
+  size_t last_allocation_count_ = 0;
+  size_t last_free_count_ = 0;
+  std::chrono::steady_clock::time_point last_render_{};
+};
+}  // namespace tracker
@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+// Layout of the shared-memory stats segment "/nv_detector.<pid>". External
+// tools map it read-only and copy each section's data under its seqlock;
+// NvStatsReadSection below does exactly that.
+//
+// Bump kNvStatsVersion whenever the layout changes.
+constexpr uint32_t kNvStatsMagic = 0x5344564e;  // "NVDS"
+constexpr uint32_t kNvStatsVersion = 3;
+constexpr size_t kNvStatsSizeClasses = 18;
+constexpr size_t kNvStatsMaxSites = 16;
+constexpr size_t kNvStatsMaxLocks = 16;
+constexpr size_t kNvStatsMaxThreads = 16;
+constexpr size_t kNvStatsSymbolLength = 64;
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "seqlock counters must be lock-free to live in shared memory");
+struct NvStatsMemory {
+  uint64_t update_ns;
+  uint64_t total_allocated;
+  uint64_t total_freed;
+  uint64_t active_allocations;
+  uint64_t active_bytes;
+  uint64_t allocation_count;
+  uint64_t free_count;
+  std::array<uint64_t, kNvStatsSizeClasses> size_classes;
+};
+using NvStatsSymbol = std::array<char, kNvStatsSymbolLength>;
+struct NvStatsSite {
+  uint64_t address;
+  uint64_t bytes;
+  uint64_t count;
+  NvStatsSymbol symbol;
+};
+struct NvStatsSites {
+  uint64_t update_ns;
+  uint64_t site_count;
+  std::array<NvStatsSite, kNvStatsMaxSites> sites;
+};
+struct NvStatsLock {
+  uint64_t address;
+  uint64_t acquisitions;
+  uint64_t contended_acquisitions;
+  uint64_t wait_ns;
+  uint64_t max_wait_ns;
+};
+struct NvStatsLocks {
+  uint64_t update_ns;
+  uint64_t acquisitions;
+  uint64_t contended_acquisitions;
+  uint64_t deadlocks_detected;
+  uint64_t total_wait_ns;
+  uint64_t lock_count;
+  std::array<NvStatsLock, kNvStatsMaxLocks> locks;
+};
+struct NvStatsThread {
+  uint64_t tid;
+  uint64_t acquisitions;
+  uint64_t contended_acquisitions;
+  uint64_t wait_ns;
+};
+struct NvStatsThreads {
+  uint64_t update_ns;
+  uint64_t thread_count;
+  std::array<NvStatsThread, kNvStatsMaxThreads> threads;
+};
+// One seqlock-protected block: odd sequence while the writer is active.
+template <typename Data>
+struct NvStatsSection {
+  std::atomic<uint64_t> sequence;
+  Data data;
+};
+struct NvStatsSegment {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;
+  int32_t pid;
+  NvStatsSection<NvStatsMemory> memory;
+  NvStatsSection<NvStatsSites> sites;
+  NvStatsSection<NvStatsLocks> lock;
+  NvStatsSection<NvStatsThreads> threads;
+};
+// Reader side of the seqlock. Returns false if the writer kept the section
+// busy for every attempt.
+template <typename Data>
+inline auto NvStatsReadSection(const NvStatsSection<Data>& section,
+                               Data* out) -> bool {
+  constexpr int kMaxAttempts = 64;
+  for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+    uint64_t begin = section.sequence.load(std::memory_order_acquire);
+    if ((begin & 1) != 0) {
+      continue;
+    }
+    *out = section.data;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (begin == section.sequence.load(std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+inline auto NvStatsSegmentName(int pid) -> std::string {
+  return "/nv_detector." + std::to_string(pid);
+}
+namespace tracker {
+// Owns the segment on the publishing side and refreshes it from the
+// detector counters. Only the service thread calls Publish.
+class StatsSegment {
+ public:
+  explicit StatsSegment(int detect_option) : detect_option_(detect_option) {}
+  ~StatsSegment() { Destroy(); }
+  auto Create() -> bool;
+  auto Destroy() -> void;
+  auto Publish() -> void;
+  StatsSegment(const StatsSegment&) = delete;
+  auto operator=(const StatsSegment&) -> StatsSegment& = delete;
+
+ private:
+  auto SymbolOf(void* site) -> NvStatsSymbol;
+  int detect_option_;
+  std::unordered_map<uint64_t, NvStatsSymbol> symbols_;
+  std::string name_;
+  NvStatsSegment* segment_ = nullptr;
+};
+}  // namespace tracker
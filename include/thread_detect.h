@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.h"
+class ThreadDetectImpl;
+// Lock-free view of the tracker totals; safe to read from a signal handler.
+struct ThreadCounters {
+  size_t created;
+  size_t exited;
+  size_t joined;
+  size_t detached;
+  size_t explicit_exits;  // pthread_exit calls from registered modules
+  size_t create_failures;
+  size_t live;
+  size_t peak_live;
+};
+// Keyed by the return address of pthread_create, i.e. the creation site.
+// Threads started through std::thread are created inside libstdc++, so that
+// module has to be registered to see them.
+struct ThreadSiteStats {
+  void* site = nullptr;
+  size_t created = 0;
+  size_t exited = 0;
+  // Joinable threads that have exited but were neither joined nor detached;
+  // each keeps its stack until the process ends.
+  size_t never_joined = 0;
+  uint64_t total_lifetime_ns = 0;
+  uint64_t max_lifetime_ns = 0;
+  LatencyHistogram lifetime{};
+};
+class ThreadDetect {
+ public:
+  static auto GetInstance() -> ThreadDetect& {
+    static ThreadDetect instance;
+    return instance;
+  }
+  void Register(const std::string& lib_name);
+  void RegisterMain();
+  void Start();
+  void Detect();
+  auto GetCounters() const -> ThreadCounters;
+  // Sites that created the most threads first.
+  auto GetCreationSites(size_t count) const -> std::vector<ThreadSiteStats>;
+  void PrintCreationSites(size_t count);
+  ~ThreadDetect();
+
+ private:
+  ThreadDetect();
+  std::unique_ptr<ThreadDetectImpl> impl_;
+};
@@ -0,0 +1,193 @@
+// LD_PRELOAD auto-start. When libnv_detector.so is loaded with NV_DETECTOR
+// set, the detector configures itself from the environment and installs its
+// hooks before main runs:
+//
+//   NV_DETECTOR              comma-separated list of memory | lock | io |
+//                            thread | blocking | fd | copy | exception |
+//                            all; "1" means memory and lock. Unknown names
+//                            are reported and ignored.
+//   NV_DETECTOR_DIR          work directory for logs and the socket (".")
+//   NV_DETECTOR_OUTPUT       console | file | both (both)
+//   NV_DETECTOR_MODULES      comma-separated modules to hook; "main" is the
+//                            executable (main)
+//   NV_DETECTOR_INTERVAL_MS  periodic report interval, 0 disables (0)
+//   NV_DETECTOR_SIGNAL       signal number that triggers a dump, e.g. 12
+//   NV_DETECTOR_SOCKET       1 enables the control socket
+//   NV_DETECTOR_PROM_INTERVAL_MS  Prometheus textfile export interval (0)
+//   NV_DETECTOR_SHM_INTERVAL_MS   shared-memory stats refresh interval (0)
+//   NV_DETECTOR_LOG_MAX_BYTES, NV_DETECTOR_LOG_MAX_FILES  log rotation
+//   NV_DETECTOR_SAMPLE_PERIOD     capture stacks for 1 in N allocations (1)
+//   NV_DETECTOR_LOCK_STACK_PERIOD capture stacks for 1 in N new locks (1)
+//   NV_DETECTOR_TRACE        comma-separated imported functions to time
+//   NV_DETECTOR_CALL_CENSUS  1 counts calls to every imported function
+//   NV_DETECTOR_COPY_STACK_BYTES  capture stacks for copies of at least
+//                                 this size (65536)
+//   NV_DETECTOR_OVERHEAD_BUDGET   adapt both periods to stay under this
+//                                 percentage of process CPU, e.g. 2
+//   NV_DETECTOR_INHERIT      1 keeps NV_DETECTOR set for child processes
+//
+// A final report is printed at exit.
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "detector.h"
+#include "output_control.h"
+static auto GetEnv(const char* name) -> const char* {
+  const char* value = getenv(name);
+  return (value != nullptr && value[0] != '\0') ? value : nullptr;
+}
+static auto GetEnvUnsigned(const char* name, unsigned long fallback)
+    -> unsigned long {
+  const char* value = GetEnv(name);
+  return value != nullptr ? strtoul(value, nullptr, 10) : fallback;
+}
+static auto ParseOutputOption(const char* value) -> OutputOption {
+  if (value == nullptr) {
+    return kOutputOptionConsoleFile;
+  }
+  if (strcmp(value, "console") == 0) {
+    return kOutputOptionConsole;
+  }
+  if (strcmp(value, "file") == 0) {
+    return kOutputOptionFile;
+  }
+  return kOutputOptionConsoleFile;
+}
+static auto ForEachListItem(const char* value,
+                            void (*callback)(const std::string&)) -> void {
+  std::string items = value;
+  size_t begin = 0;
+  while (begin <= items.size()) {
+    size_t end = items.find(',', begin);
+    if (end == std::string::npos) {
+      end = items.size();
+    }
+    std::string item = items.substr(begin, end - begin);
+    if (!item.empty()) {
+      callback(item);
+    }
+    begin = end + 1;
+  }
+}
+static auto DetectOptionByName(const std::string& name) -> int {
+  struct Named {
+    const char* name;
+    int option;
+  };
+  static constexpr Named kOptions[] = {
+      {"memory", kDetectorOptionMemory},
+      {"lock", kDetectorOptionLock},
+      {"io", kDetectorOptionIo},
+      {"thread", kDetectorOptionThread},
+      {"blocking", kDetectorOptionBlocking},
+      {"fd", kDetectorOptionFd},
+      {"copy", kDetectorOptionCopy},
+      {"exception", kDetectorOptionException},
+      {"all", kDetectorOptionAll},
+      {"1", kDetectorOptionMemoryLock},
+  };
+  for (const auto& option : kOptions) {
+    if (name == option.name) {
+      return option.option;
+    }
+  }
+  TRACKER_WARNING("NV_DETECTOR: unknown detector \"%s\" ignored\n",
+                  name.c_str());
+  return 0;
+}
+static int parsed_detect_option = 0;
+static auto ParseDetectOption(const char* value) -> DetectorOption {
+  parsed_detect_option = 0;
+  ForEachListItem(value, [](const std::string& name) {
+    parsed_detect_option |= DetectOptionByName(name);
+  });
+  return static_cast<DetectorOption>(parsed_detect_option);
+}
+static auto RegisterModules(const char* value) -> void {
+  if (value == nullptr) {
+    DetectorRegisterMain();
+    return;
+  }
+  ForEachListItem(value, [](const std::string& module) {
+    if (module == "main") {
+      DetectorRegisterMain();
+    } else {
+      DetectorRegister(module.c_str());
+    }
+  });
+}
+static auto ReportAtExit() -> void {
+  DetectorStop();
+  DetectorDetect();
+}
+__attribute__((constructor)) static auto AutoStart() -> void {
+  const char* enabled = GetEnv("NV_DETECTOR");
+  if (enabled == nullptr || strcmp(enabled, "0") == 0) {
+    return;
+  }
+  DetectorOption detect_option = ParseDetectOption(enabled);
+  if (detect_option == 0) {
+    TRACKER_WARNING("NV_DETECTOR=%s enables no detector\n", enabled);
+    return;
+  }
+  // Children (e.g. the addr2line helper used for symbolization) must not
+  // start their own detector unless asked to.
+  if (GetEnvUnsigned("NV_DETECTOR_INHERIT", 0) == 0) {
+    unsetenv("NV_DETECTOR");
+  }
+  const char* work_dir = GetEnv("NV_DETECTOR_DIR");
+  DetectorInit(work_dir != nullptr ? work_dir : ".", detect_option,
+               ParseOutputOption(GetEnv("NV_DETECTOR_OUTPUT")));
+  DetectorSetLogRotation(GetEnvUnsigned("NV_DETECTOR_LOG_MAX_BYTES", 0),
+                         GetEnvUnsigned("NV_DETECTOR_LOG_MAX_FILES", 0));
+  DetectorSetSampling(
+      static_cast<unsigned int>(GetEnvUnsigned("NV_DETECTOR_SAMPLE_PERIOD", 1)),
+      static_cast<unsigned int>(
+          GetEnvUnsigned("NV_DETECTOR_LOCK_STACK_PERIOD", 1)));
+  if (GetEnv("NV_DETECTOR_COPY_STACK_BYTES") != nullptr) {
+    DetectorSetCopyStackThreshold(
+        GetEnvUnsigned("NV_DETECTOR_COPY_STACK_BYTES", 0));
+  }
+  RegisterModules(GetEnv("NV_DETECTOR_MODULES"));
+  DetectorStart();
+  const char* traced = GetEnv("NV_DETECTOR_TRACE");
+  if (traced != nullptr) {
+    ForEachListItem(traced, [](const std::string& symbol) {
+      DetectorTraceFunction(symbol.c_str());
+    });
+  }
+  if (GetEnvUnsigned("NV_DETECTOR_CALL_CENSUS", 0) != 0) {
+    DetectorStartCallCensus();
+  }
+  const char* budget = GetEnv("NV_DETECTOR_OVERHEAD_BUDGET");
+  if (budget != nullptr) {
+    DetectorSetOverheadBudget(strtod(budget, nullptr));
+  }
+  auto interval_ms =
+      static_cast<unsigned int>(GetEnvUnsigned("NV_DETECTOR_INTERVAL_MS", 0));
+  if (interval_ms != 0) {
+    DetectorStartPeriodic(interval_ms, detect_option);
+  }
+  auto signal_number =
+      static_cast<int>(GetEnvUnsigned("NV_DETECTOR_SIGNAL", 0));
+  if (signal_number != 0) {
+    DetectorEnableSignalDump(signal_number);
+  }
+  if (GetEnvUnsigned("NV_DETECTOR_SOCKET", 0) != 0) {
+    DetectorEnableControlSocket();
+  }
+  auto export_interval_ms = static_cast<unsigned int>(
+      GetEnvUnsigned("NV_DETECTOR_PROM_INTERVAL_MS", 0));
+  if (export_interval_ms != 0) {
+    DetectorStartPrometheusExport(export_interval_ms);
+  }
+  auto segment_interval_ms = static_cast<unsigned int>(
+      GetEnvUnsigned("NV_DETECTOR_SHM_INTERVAL_MS", 0));
+  if (segment_interval_ms != 0) {
+    DetectorStartStatsSegment(segment_interval_ms);
+  }
+  // Registered last so it runs before the singletons created above are
+  // destroyed.
+  atexit(ReportAtExit);
+}
@@ -0,0 +1,535 @@
+#include "blocking_detect.h"
+
+#include <dlfcn.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/epoll.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "output_control.h"
+#include "overhead.h"
+#include "plthook.h"
+auto BlockingOpName(BlockingOp op) -> const char* {
+  switch (op) {
+    case BlockingOp::kPoll:
+      return "poll";
+    case BlockingOp::kPpoll:
+      return "ppoll";
+    case BlockingOp::kEpollWait:
+      return "epoll_wait";
+    case BlockingOp::kEpollPwait:
+      return "epoll_pwait";
+    case BlockingOp::kSelect:
+      return "select";
+    case BlockingOp::kPselect:
+      return "pselect";
+    case BlockingOp::kNanosleep:
+      return "nanosleep";
+    case BlockingOp::kClockNanosleep:
+      return "clock_nanosleep";
+    case BlockingOp::kUsleep:
+      return "usleep";
+    case BlockingOp::kSleep:
+      return "sleep";
+    case BlockingOp::kAccept:
+      return "accept";
+    case BlockingOp::kAccept4:
+      return "accept4";
+    case BlockingOp::kConnect:
+      return "connect";
+    case BlockingOp::kCondWait:
+      return "pthread_cond_wait";
+    case BlockingOp::kCondTimedwait:
+      return "pthread_cond_timedwait";
+    case BlockingOp::kSemWait:
+      return "sem_wait";
+    case BlockingOp::kSemTimedwait:
+      return "sem_timedwait";
+    case BlockingOp::kRwlockRdlock:
+      return "pthread_rwlock_rdlock";
+    case BlockingOp::kRwlockWrlock:
+      return "pthread_rwlock_wrlock";
+    case BlockingOp::kWaitpid:
+      return "waitpid";
+    case BlockingOp::kWait:
+      return "wait";
+    case BlockingOp::kCount:
+      break;
+  }
+  return "?";
+}
+namespace tracker {
+// The overhead hook kinds mirror BlockingOp one to one.
+static_assert(static_cast<size_t>(HookKind::kWait) -
+                      static_cast<size_t>(HookKind::kPoll) + 1 ==
+                  kBlockingOpCount,
+              "HookKind and BlockingOp are out of sync");
+static auto HookKindFor(BlockingOp op) -> HookKind {
+  return static_cast<HookKind>(static_cast<size_t>(HookKind::kPoll) +
+                               static_cast<size_t>(op));
+}
+class BlockingTracker {
+ public:
+  static auto GetInstance() -> BlockingTracker& {
+    static BlockingTracker instance;
+    return instance;
+  }
+  BlockingTracker(const BlockingTracker&) = delete;
+  auto operator=(const BlockingTracker&) -> BlockingTracker& = delete;
+  auto RecordCall(BlockingOp op, void* site, uint64_t blocked_ns) -> void;
+  auto GetCounters() const -> BlockingCounters {
+    return {calls_.load(std::memory_order_relaxed),
+            blocked_ns_.load(std::memory_order_relaxed)};
+  }
+  auto GetTopSites(size_t count) const -> std::vector<BlockingSiteStats>;
+  auto GetTopThreads(size_t count) const -> std::vector<BlockingThreadStats>;
+  auto PrintStatus(size_t count) const -> void;
+
+ private:
+  BlockingTracker() = default;
+  // gettid() is a real syscall; cache it per thread
+  static auto CurrentTid() -> pid_t {
+    static thread_local pid_t tid = gettid();
+    return tid;
+  }
+  mutable std::mutex mutex_;
+  std::unordered_map<void*, BlockingSiteStats> sites_;
+  std::unordered_map<pid_t, BlockingThreadStats> threads_;
+  std::atomic<size_t> calls_ = 0;
+  std::atomic<uint64_t> blocked_ns_ = 0;
+};
+static auto Instance() -> BlockingTracker& {
+  return BlockingTracker::GetInstance();
+}
+auto BlockingTracker::RecordCall(BlockingOp op, void* site,
+                                 uint64_t blocked_ns) -> void {
+  calls_.fetch_add(1, std::memory_order_relaxed);
+  blocked_ns_.fetch_add(blocked_ns, std::memory_order_relaxed);
+  size_t bucket = LatencyBucket(blocked_ns);
+  pid_t tid = CurrentTid();
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& site_stats = sites_[site];
+  site_stats.site = site;
+  site_stats.op = op;
+  site_stats.calls++;
+  site_stats.blocked_ns += blocked_ns;
+  site_stats.max_ns = std::max(site_stats.max_ns, blocked_ns);
+  site_stats.latency[bucket]++;
+  auto& thread_stats = threads_[tid];
+  thread_stats.tid = tid;
+  thread_stats.calls++;
+  thread_stats.blocked_ns += blocked_ns;
+  thread_stats.blocked_ns_by_op[static_cast<size_t>(op)] += blocked_ns;
+}
+auto BlockingTracker::GetTopSites(size_t count) const
+    -> std::vector<BlockingSiteStats> {
+  std::vector<BlockingSiteStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(sites_.size());
+    for (const auto& pair : sites_) {
+      result.push_back(pair.second);
+    }
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.blocked_ns > rhs.blocked_ns;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto BlockingTracker::GetTopThreads(size_t count) const
+    -> std::vector<BlockingThreadStats> {
+  std::vector<BlockingThreadStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(threads_.size());
+    for (const auto& pair : threads_) {
+      result.push_back(pair.second);
+    }
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.blocked_ns > rhs.blocked_ns;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto BlockingTracker::PrintStatus(size_t count) const -> void {
+  constexpr double kNsPerUs = 1000.0;
+  constexpr double kNsPerMs = 1000000.0;
+  constexpr double kP99 = 0.99;
+  BlockingCounters counters = GetCounters();
+  std::vector<BlockingSiteStats> sites = GetTopSites(count);
+  std::vector<BlockingThreadStats> threads = GetTopThreads(count);
+  ReportSection section;
+  TRACKER_PRINT("\n\n=== Off-CPU Profile ===\n");
+  TRACKER_PRINT("Blocking calls: %zu, blocked: %.2f ms\n", counters.calls,
+                static_cast<double>(counters.blocked_ns) / kNsPerMs);
+  if (!sites.empty()) {
+    TRACKER_PRINT("\nSites by blocked time:\n");
+  }
+  for (size_t i = 0; i < sites.size(); ++i) {
+    const auto& site = sites[i];
+    Dl_info dlinfo;
+    const char* symbol = "??";
+    const char* module = "??";
+    if (site.site != nullptr && dladdr(site.site, &dlinfo) != 0) {
+      symbol = dlinfo.dli_sname != nullptr ? dlinfo.dli_sname : symbol;
+      module = dlinfo.dli_fname != nullptr ? dlinfo.dli_fname : module;
+    }
+    uint64_t p99 = LatencyPercentile(site.latency, kP99, site.max_ns);
+    TRACKER_PRINT("[%zu] %s at %p %s (%s)\n", i, BlockingOpName(site.op),
+                  site.site, symbol, module);
+    TRACKER_PRINT(
+        "    calls: %zu, blocked: %.2f ms, avg: %.1f us, p99: %.1f us, "
+        "max: %.1f us\n",
+        site.calls, static_cast<double>(site.blocked_ns) / kNsPerMs,
+        static_cast<double>(site.blocked_ns) /
+            static_cast<double>(site.calls) / kNsPerUs,
+        static_cast<double>(p99) / kNsPerUs,
+        static_cast<double>(site.max_ns) / kNsPerUs);
+  }
+  if (!threads.empty()) {
+    TRACKER_PRINT("\nThreads by blocked time:\n");
+  }
+  for (const auto& thread : threads) {
+    auto top = std::ranges::max_element(thread.blocked_ns_by_op);
+    auto top_op = static_cast<BlockingOp>(
+        std::distance(thread.blocked_ns_by_op.begin(), top));
+    TRACKER_PRINT(
+        "  tid %d: calls: %zu, blocked: %.2f ms, mostly in %s (%.2f ms)\n",
+        thread.tid, thread.calls,
+        static_cast<double>(thread.blocked_ns) / kNsPerMs,
+        BlockingOpName(top_op), static_cast<double>(*top) / kNsPerMs);
+  }
+  TRACKER_PRINT("===========================\n");
+}
+}  // namespace tracker
+// Shared tail of every blocking hook. Keeps errno intact for the caller,
+// since recording may allocate.
+static auto RecordBlocking(BlockingOp op, void* site,
+                           std::chrono::steady_clock::time_point start)
+    -> void {
+  auto blocked = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+  int saved_errno = errno;
+  {
+    tracker::HookScope scope(tracker::HookKindFor(op));
+    tracker::Instance().RecordCall(op, site,
+                                   static_cast<uint64_t>(blocked.count()));
+  }
+  errno = saved_errno;
+}
+static auto HookedPoll(struct pollfd* fds, nfds_t nfds, int timeout) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = poll(fds, nfds, timeout);
+  RecordBlocking(BlockingOp::kPoll, site, start);
+  return result;
+}
+static auto HookedPpoll(struct pollfd* fds, nfds_t nfds,
+                        const struct timespec* timeout,
+                        const sigset_t* sigmask) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = ppoll(fds, nfds, timeout, sigmask);
+  RecordBlocking(BlockingOp::kPpoll, site, start);
+  return result;
+}
+static auto HookedEpollWait(int epfd, struct epoll_event* events,
+                            int maxevents, int timeout) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = epoll_wait(epfd, events, maxevents, timeout);
+  RecordBlocking(BlockingOp::kEpollWait, site, start);
+  return result;
+}
+static auto HookedEpollPwait(int epfd, struct epoll_event* events,
+                             int maxevents, int timeout,
+                             const sigset_t* sigmask) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = epoll_pwait(epfd, events, maxevents, timeout, sigmask);
+  RecordBlocking(BlockingOp::kEpollPwait, site, start);
+  return result;
+}
+static auto HookedSelect(int nfds, fd_set* readfds, fd_set* writefds,
+                         fd_set* exceptfds, struct timeval* timeout) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = select(nfds, readfds, writefds, exceptfds, timeout);
+  RecordBlocking(BlockingOp::kSelect, site, start);
+  return result;
+}
+static auto HookedPselect(int nfds, fd_set* readfds, fd_set* writefds,
+                          fd_set* exceptfds, const struct timespec* timeout,
+                          const sigset_t* sigmask) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = pselect(nfds, readfds, writefds, exceptfds, timeout, sigmask);
+  RecordBlocking(BlockingOp::kPselect, site, start);
+  return result;
+}
+static auto HookedNanosleep(const struct timespec* request,
+                            struct timespec* remaining) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = nanosleep(request, remaining);
+  RecordBlocking(BlockingOp::kNanosleep, site, start);
+  return result;
+}
+static auto HookedClockNanosleep(clockid_t clock_id, int flags,
+                                 const struct timespec* request,
+                                 struct timespec* remaining) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = clock_nanosleep(clock_id, flags, request, remaining);
+  RecordBlocking(BlockingOp::kClockNanosleep, site, start);
+  return result;
+}
+static auto HookedUsleep(useconds_t usec) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = usleep(usec);
+  RecordBlocking(BlockingOp::kUsleep, site, start);
+  return result;
+}
+static auto HookedSleep(unsigned int seconds) -> unsigned int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  unsigned int result = sleep(seconds);
+  RecordBlocking(BlockingOp::kSleep, site, start);
+  return result;
+}
+static auto HookedAccept(int fd, struct sockaddr* addr, socklen_t* addrlen)
+    -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = accept(fd, addr, addrlen);
+  RecordBlocking(BlockingOp::kAccept, site, start);
+  return result;
+}
+static auto HookedAccept4(int fd, struct sockaddr* addr, socklen_t* addrlen,
+                          int flags) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = accept4(fd, addr, addrlen, flags);
+  RecordBlocking(BlockingOp::kAccept4, site, start);
+  return result;
+}
+static auto HookedConnect(int fd, const struct sockaddr* addr,
+                          socklen_t addrlen) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = connect(fd, addr, addrlen);
+  RecordBlocking(BlockingOp::kConnect, site, start);
+  return result;
+}
+static auto HookedCondWait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+    -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = pthread_cond_wait(cond, mutex);
+  RecordBlocking(BlockingOp::kCondWait, site, start);
+  return result;
+}
+static auto HookedCondTimedwait(pthread_cond_t* cond, pthread_mutex_t* mutex,
+                                const struct timespec* abstime) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = pthread_cond_timedwait(cond, mutex, abstime);
+  RecordBlocking(BlockingOp::kCondTimedwait, site, start);
+  return result;
+}
+static auto HookedSemWait(sem_t* sem) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = sem_wait(sem);
+  RecordBlocking(BlockingOp::kSemWait, site, start);
+  return result;
+}
+static auto HookedSemTimedwait(sem_t* sem, const struct timespec* abstime)
+    -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = sem_timedwait(sem, abstime);
+  RecordBlocking(BlockingOp::kSemTimedwait, site, start);
+  return result;
+}
+static auto HookedRwlockRdlock(pthread_rwlock_t* rwlock) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = pthread_rwlock_rdlock(rwlock);
+  RecordBlocking(BlockingOp::kRwlockRdlock, site, start);
+  return result;
+}
+static auto HookedRwlockWrlock(pthread_rwlock_t* rwlock) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = pthread_rwlock_wrlock(rwlock);
+  RecordBlocking(BlockingOp::kRwlockWrlock, site, start);
+  return result;
+}
+static auto HookedWaitpid(pid_t pid, int* status, int options) -> pid_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  pid_t result = waitpid(pid, status, options);
+  RecordBlocking(BlockingOp::kWaitpid, site, start);
+  return result;
+}
+static auto HookedWait(int* status) -> pid_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  pid_t result = wait(status);
+  RecordBlocking(BlockingOp::kWait, site, start);
+  return result;
+}
+class BlockingHook {
+ public:
+  explicit BlockingHook(std::string lib_path)
+      : lib_path_(std::move(lib_path)) {}
+  ~BlockingHook() = default;
+  auto Start() -> void;
+
+ private:
+  std::string lib_path_;
+  std::unique_ptr<PltHook> hook_;
+};
+auto BlockingHook::Start() -> void {
+  hook_ = PltHook::Create(lib_path_.c_str());
+  try {
+    std::vector<std::string> hooked_functions;
+    auto try_hook = [&](const char* symbol, void* hook_func) {
+      if (hook_->ReplaceFunction(symbol, hook_func, nullptr) ==
+          PltHook::ErrorCode::kSuccess) {
+        hooked_functions.emplace_back(symbol);
+      }
+    };
+    try_hook("poll", reinterpret_cast<void*>(&HookedPoll));
+    try_hook("ppoll", reinterpret_cast<void*>(&HookedPpoll));
+    try_hook("epoll_wait", reinterpret_cast<void*>(&HookedEpollWait));
+    try_hook("epoll_pwait", reinterpret_cast<void*>(&HookedEpollPwait));
+    try_hook("select", reinterpret_cast<void*>(&HookedSelect));
+    try_hook("pselect", reinterpret_cast<void*>(&HookedPselect));
+    try_hook("nanosleep", reinterpret_cast<void*>(&HookedNanosleep));
+    try_hook("clock_nanosleep",
+             reinterpret_cast<void*>(&HookedClockNanosleep));
+    try_hook("usleep", reinterpret_cast<void*>(&HookedUsleep));
+    try_hook("sleep", reinterpret_cast<void*>(&HookedSleep));
+    try_hook("accept", reinterpret_cast<void*>(&HookedAccept));
+    try_hook("accept4", reinterpret_cast<void*>(&HookedAccept4));
+    try_hook("connect", reinterpret_cast<void*>(&HookedConnect));
+    try_hook("pthread_cond_wait", reinterpret_cast<void*>(&HookedCondWait));
+    try_hook("pthread_cond_timedwait",
+             reinterpret_cast<void*>(&HookedCondTimedwait));
+    try_hook("sem_wait", reinterpret_cast<void*>(&HookedSemWait));
+    try_hook("sem_timedwait", reinterpret_cast<void*>(&HookedSemTimedwait));
+    try_hook("pthread_rwlock_rdlock",
+             reinterpret_cast<void*>(&HookedRwlockRdlock));
+    try_hook("pthread_rwlock_wrlock",
+             reinterpret_cast<void*>(&HookedRwlockWrlock));
+    try_hook("waitpid", reinterpret_cast<void*>(&HookedWaitpid));
+    try_hook("wait", reinterpret_cast<void*>(&HookedWait));
+    tracker::ReportSection section;
+    auto& output = tracker::OutputControl::Instance();
+    output.PrintColored(tracker::Color::kGreen, tracker::Color::kReset,
+                        "Hooked blocking functions: ");
+    for (size_t i = 0; i < hooked_functions.size(); ++i) {
+      TRACKER_PRINT("%s", hooked_functions[i].c_str());
+      if (i < hooked_functions.size() - 1) {
+        TRACKER_PRINT(", ");
+      }
+    }
+    TRACKER_PRINT("\n");
+  } catch (const std::exception& e) {
+    TRACKER_ERROR("Error starting blocking-call tracking: %s", e.what());
+  }
+}
+class BlockingDetectImpl {
+ public:
+  BlockingDetectImpl() = default;
+  ~BlockingDetectImpl() = default;
+  auto Register(const std::string& lib_name) -> void;
+  auto RegisterMain() -> void;
+  auto Start() -> void;
+  auto Detect() -> void;
+  auto GetCounters() const -> BlockingCounters;
+  auto GetTopSites(size_t count) const -> std::vector<BlockingSiteStats>;
+  auto GetTopThreads(size_t count) const -> std::vector<BlockingThreadStats>;
+  auto PrintTopSites(size_t count) -> void;
+
+ private:
+  std::vector<std::unique_ptr<BlockingHook>> hooks_;
+};
+auto BlockingDetectImpl::Register(const std::string& lib_name) -> void {
+  hooks_.emplace_back(std::make_unique<BlockingHook>(lib_name));
+}
+auto BlockingDetectImpl::RegisterMain() -> void {
+  hooks_.emplace_back(std::make_unique<BlockingHook>(std::string()));
+}
+auto BlockingDetectImpl::Start() -> void {
+  tracker::Instance();
+  tracker::OverheadAccounting::Instance().Start();
+  for (auto& hook : hooks_) {
+    hook->Start();
+  }
+}
+auto BlockingDetectImpl::Detect() -> void {
+  constexpr size_t kReportCount = 10;
+  tracker::Instance().PrintStatus(kReportCount);
+}
+auto BlockingDetectImpl::GetCounters() const -> BlockingCounters {
+  return tracker::Instance().GetCounters();
+}
+auto BlockingDetectImpl::GetTopSites(size_t count) const
+    -> std::vector<BlockingSiteStats> {
+  return tracker::Instance().GetTopSites(count);
+}
+auto BlockingDetectImpl::GetTopThreads(size_t count) const
+    -> std::vector<BlockingThreadStats> {
+  return tracker::Instance().GetTopThreads(count);
+}
+auto BlockingDetectImpl::PrintTopSites(size_t count) -> void {
+  tracker::Instance().PrintStatus(count);
+}
+BlockingDetect::BlockingDetect()
+    : impl_(std::make_unique<BlockingDetectImpl>()) {}
+BlockingDetect::~BlockingDetect() = default;
+auto BlockingDetect::Register(const std::string& lib_name) -> void {
+  impl_->Register(lib_name);
+}
+auto BlockingDetect::RegisterMain() -> void { impl_->RegisterMain(); }
+auto BlockingDetect::Start() -> void { impl_->Start(); }
+auto BlockingDetect::Detect() -> void { impl_->Detect(); }
+auto BlockingDetect::GetCounters() const -> BlockingCounters {
+  return impl_->GetCounters();
+}
+auto BlockingDetect::GetTopSites(size_t count) const
+    -> std::vector<BlockingSiteStats> {
+  return impl_->GetTopSites(count);
+}
+auto BlockingDetect::GetTopThreads(size_t count) const
+    -> std::vector<BlockingThreadStats> {
+  return impl_->GetTopThreads(count);
+}
+auto BlockingDetect::PrintTopSites(size_t count) -> void {
+  impl_->PrintTopSites(count);
+}
@@ -0,0 +1,146 @@
+#include "control_socket.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include "output_control.h"
+namespace tracker {
+constexpr size_t kMaxClients = 8;
+constexpr size_t kMaxLineLength = 4096;
+// A client this far behind on reading its replies is dropped.
+constexpr size_t kMaxPendingOutput = 1 << 20;
+auto ControlSocket::Listen(const std::string& path) -> bool {
+  Close();
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    TRACKER_ERROR("Control socket path too long: %s\n", path.c_str());
+    return false;
+  }
+  memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (listen_fd_ < 0) {
+    TRACKER_ERROR("Failed to create control socket: %s\n", strerror(errno));
+    return false;
+  }
+  unlink(path.c_str());
+  constexpr int kBacklog = 4;
+  constexpr mode_t kSocketMode = 0600;
+  if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) !=
+          0 ||
+      chmod(path.c_str(), kSocketMode) != 0 ||
+      listen(listen_fd_, kBacklog) != 0) {
+    TRACKER_ERROR("Failed to listen on %s: %s\n", path.c_str(),
+                  strerror(errno));
+    close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+  path_ = path;
+  TRACKER_PRINT("Control socket listening on %s\n", path_.c_str());
+  return true;
+}
+auto ControlSocket::Close() -> void {
+  for (auto& client : clients_) {
+    close(client.fd);
+  }
+  clients_.clear();
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    listen_fd_ = -1;
+    unlink(path_.c_str());
+  }
+}
+auto ControlSocket::AppendPollFds(std::vector<pollfd>& fds) const -> void {
+  if (listen_fd_ < 0) {
+    return;
+  }
+  fds.push_back({listen_fd_, POLLIN, 0});
+  for (const auto& client : clients_) {
+    auto events =
+        static_cast<short>(POLLIN | (client.output.empty() ? 0 : POLLOUT));
+    fds.push_back({client.fd, events, 0});
+  }
+}
+// fds must be the entries produced by the matching AppendPollFds call.
+auto ControlSocket::HandlePollFds(const pollfd* fds, size_t count) -> void {
+  if (listen_fd_ < 0 || count == 0) {
+    return;
+  }
+  std::vector<int> closed_fds;
+  for (size_t i = 1; i < count && i - 1 < clients_.size(); ++i) {
+    if (fds[i].revents != 0 && !ServeClient(clients_[i - 1])) {
+      closed_fds.push_back(clients_[i - 1].fd);
+    }
+  }
+  std::erase_if(clients_, [&](const Client& client) {
+    return std::ranges::find(closed_fds, client.fd) != closed_fds.end();
+  });
+  for (int fd : closed_fds) {
+    close(fd);
+  }
+  if ((fds[0].revents & POLLIN) != 0) {
+    Accept();
+  }
+}
+auto ControlSocket::Accept() -> void {
+  int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  if (clients_.size() >= kMaxClients) {
+    close(fd);
+    return;
+  }
+  clients_.push_back({fd, std::string(), std::string()});
+}
+// Returns false once the client has hung up or misbehaved.
+auto ControlSocket::ServeClient(Client& client) -> bool {
+  constexpr size_t kReadBufferSize = 512;
+  std::array<char, kReadBufferSize> buf{};
+  ssize_t received = recv(client.fd, buf.data(), buf.size(), MSG_DONTWAIT);
+  if (received == 0 ||
+      (received < 0 && errno != EAGAIN && errno != EINTR)) {
+    return false;
+  }
+  if (received > 0) {
+    client.input.append(buf.data(), static_cast<size_t>(received));
+  }
+  size_t newline = 0;
+  while ((newline = client.input.find('\n')) != std::string::npos) {
+    std::string line = client.input.substr(0, newline);
+    client.input.erase(0, newline + 1);
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    client.output += handler_(line);
+  }
+  return Flush(client) && client.input.size() <= kMaxLineLength &&
+         client.output.size() <= kMaxPendingOutput;
+}
+// Sends what the socket takes without blocking, so a client that stops
+// reading never stalls the service thread; the rest waits for POLLOUT.
+auto ControlSocket::Flush(Client& client) -> bool {
+  size_t sent = 0;
+  while (sent < client.output.size()) {
+    ssize_t n = send(client.fd, client.output.data() + sent,
+                     client.output.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        break;
+      }
+      return false;
+    }
+    sent += static_cast<size_t>(n);
+  }
+  client.output.erase(0, sent);
+  return true;
+}
+}  // namespace tracker
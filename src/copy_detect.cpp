@@ -0,0 +1,562 @@
+#include "copy_detect.h"
+
+#include <dlfcn.h>
+#include <execinfo.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "output_control.h"
+#include "overhead.h"
+#include "plthook.h"
+// Fortified builds (_FORTIFY_SOURCE) call these instead of the plain names.
+extern "C" {
+auto __memcpy_chk(void* dst, const void* src, size_t len, size_t dstlen)
+    -> void*;
+auto __memmove_chk(void* dst, const void* src, size_t len, size_t dstlen)
+    -> void*;
+auto __memset_chk(void* dst, int value, size_t len, size_t dstlen) -> void*;
+auto __stpcpy_chk(char* dst, const char* src, size_t dstlen) -> char*;
+}
+auto CopyOpName(CopyOp op) -> const char* {
+  switch (op) {
+    case CopyOp::kMemcpy:
+      return "memcpy";
+    case CopyOp::kMemmove:
+      return "memmove";
+    case CopyOp::kMemset:
+      return "memset";
+    case CopyOp::kStrcpy:
+      return "strcpy";
+    case CopyOp::kStrlen:
+      return "strlen";
+    case CopyOp::kCount:
+      break;
+  }
+  return "?";
+}
+auto CopySizeBucketName(size_t bucket) -> const char* {
+  static constexpr std::array<const char*, kCopySizeBucketCount> kNames = {
+      "<=16", "<=64", "<=256", "<=1K", "<=4K", "<=16K", "<=64K", "<=256K",
+      ">256K"};
+  return bucket < kNames.size() ? kNames[bucket] : "?";
+}
+namespace tracker {
+static auto HookKindFor(CopyOp op) -> HookKind {
+  switch (op) {
+    case CopyOp::kMemcpy:
+      return HookKind::kMemcpy;
+    case CopyOp::kMemmove:
+      return HookKind::kMemmove;
+    case CopyOp::kMemset:
+      return HookKind::kMemset;
+    case CopyOp::kStrcpy:
+      return HookKind::kStrcpy;
+    case CopyOp::kStrlen:
+    case CopyOp::kCount:
+      break;
+  }
+  return HookKind::kStrlen;
+}
+static auto SizeBucket(size_t bytes) -> size_t {
+  constexpr size_t kSmallestBucketBytes = 16;
+  constexpr size_t kSmallestBucketBits = 3;
+  if (bytes <= kSmallestBucketBytes) {
+    return 0;
+  }
+  return std::min<size_t>(
+      (static_cast<size_t>(std::bit_width(bytes - 1)) - kSmallestBucketBits) /
+          2,
+      kCopySizeBucketCount - 1);
+}
+// Written once when a site claims its slot, then only read.
+struct CopySiteSlot {
+  std::atomic<uintptr_t> site;
+  std::atomic<CopyOp> op;
+};
+// The call count is the sum of the size buckets, so a copy costs two
+// relaxed adds on the site's counters in the calling thread's stripe.
+struct CopySiteCounters {
+  std::atomic<size_t> bytes;
+  std::array<std::atomic<size_t>, kCopySizeBucketCount> sizes;
+};
+class CopyTracker {
+ public:
+  static auto GetInstance() -> CopyTracker& {
+    static CopyTracker instance;
+    return instance;
+  }
+  CopyTracker(const CopyTracker&) = delete;
+  auto operator=(const CopyTracker&) -> CopyTracker& = delete;
+  auto RecordCopy(CopyOp op, void* site, size_t bytes) -> void {
+    size_t bucket = SizeBucket(bytes);
+    size_t slot = FindSlot(op, reinterpret_cast<uintptr_t>(site));
+    if (slot == kSiteSlots) {
+      untracked_calls_.fetch_add(1, std::memory_order_relaxed);
+      untracked_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+      return;
+    }
+    CopySiteCounters& counters = Stripe().sites[slot];
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    counters.sizes[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+  auto RecordLargeCopy(CopyOp op, size_t bytes) -> void;
+  auto GetCounters() const -> CopyCounters;
+  auto SetStackThreshold(size_t bytes) -> void {
+    stack_threshold_.store(bytes, std::memory_order_relaxed);
+  }
+  auto GetStackThreshold() const -> size_t {
+    return stack_threshold_.load(std::memory_order_relaxed);
+  }
+  auto GetTopSites(size_t count) const -> std::vector<CopySiteStats>;
+  auto GetTopStacks(size_t count) const -> std::vector<CopyStackStats>;
+  auto PrintStatus(size_t count) const -> void;
+
+ private:
+  static constexpr size_t kSiteSlotBits = 12;
+  static constexpr size_t kSiteSlots = size_t{1} << kSiteSlotBits;
+  static constexpr size_t kMaxProbes = 32;
+  static constexpr size_t kStripes = 8;
+  static constexpr size_t kDefaultStackThreshold = size_t{64} << 10;
+  CopyTracker() = default;
+  // Open addressing with linear probing; slots are claimed once and never
+  // released, so lookups need no lock. Returns kSiteSlots when the probe
+  // limit is reached.
+  auto FindSlot(CopyOp op, uintptr_t site) -> size_t {
+    constexpr uint64_t kGoldenRatio = 0x9E3779B97F4A7C15ULL;
+    size_t hash = static_cast<size_t>(((site >> 4) * kGoldenRatio) >>
+                                      (64 - kSiteSlotBits));
+    for (size_t probe = 0; probe < kMaxProbes; ++probe) {
+      size_t index = (hash + probe) & (kSiteSlots - 1);
+      CopySiteSlot& slot = sites_[index];
+      uintptr_t current = slot.site.load(std::memory_order_acquire);
+      if (current == site) {
+        return index;
+      }
+      if (current == 0) {
+        if (slot.site.compare_exchange_strong(current, site,
+                                              std::memory_order_acq_rel)) {
+          slot.op.store(op, std::memory_order_relaxed);
+          return index;
+        }
+        if (current == site) {
+          return index;
+        }
+      }
+    }
+    return kSiteSlots;
+  }
+  // Threads are spread over cache-line-aligned stripes, as in the overhead
+  // accounting, so copies from different threads at the same site do not
+  // bounce one counter line between cores; reports sum the stripes.
+  struct alignas(64) CopyStripe {
+    std::array<CopySiteCounters, kSiteSlots> sites{};
+  };
+  auto Stripe() -> CopyStripe& {
+    static thread_local size_t index =
+        next_stripe_.fetch_add(1, std::memory_order_relaxed) % kStripes;
+    return stripes_[index];
+  }
+  // The slot's site and its counters summed over all stripes.
+  auto SumSlot(size_t slot) const -> CopySiteStats;
+  std::array<CopySiteSlot, kSiteSlots> sites_{};
+  std::array<CopyStripe, kStripes> stripes_{};
+  std::atomic<size_t> next_stripe_ = 0;
+  std::atomic<size_t> untracked_calls_ = 0;
+  std::atomic<size_t> untracked_bytes_ = 0;
+  std::atomic<size_t> large_copies_ = 0;
+  std::atomic<size_t> stack_threshold_ = kDefaultStackThreshold;
+  mutable std::mutex mutex_;
+  std::unordered_map<uint64_t, CopyStackStats> stacks_;
+};
+static auto Instance() -> CopyTracker& { return CopyTracker::GetInstance(); }
+auto CopyTracker::RecordLargeCopy(CopyOp op, size_t bytes) -> void {
+  constexpr int kMaxStackDepth = 16;
+  constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+  constexpr uint64_t kFnvPrime = 1099511628211ULL;
+  large_copies_.fetch_add(1, std::memory_order_relaxed);
+  std::array<void*, kMaxStackDepth> stack{};
+  int depth = 0;
+  {
+    PhaseScope unwind(OverheadPhase::kUnwind);
+    depth = backtrace(stack.data(), kMaxStackDepth);
+  }
+  uint64_t key = kFnvOffset ^ static_cast<uint64_t>(op);
+  for (int i = 0; i < depth; ++i) {
+    key = (key ^ reinterpret_cast<uintptr_t>(stack[static_cast<size_t>(i)])) *
+          kFnvPrime;
+  }
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& stats = stacks_[key];
+  if (stats.calls == 0) {
+    stats.op = op;
+    stats.callstack.assign(stack.begin(), stack.begin() + depth);
+  }
+  stats.calls++;
+  stats.bytes += bytes;
+  stats.max_bytes = std::max(stats.max_bytes, bytes);
+}
+auto CopyTracker::GetCounters() const -> CopyCounters {
+  CopyCounters counters{untracked_calls_.load(std::memory_order_relaxed),
+                        untracked_bytes_.load(std::memory_order_relaxed),
+                        large_copies_.load(std::memory_order_relaxed),
+                        untracked_calls_.load(std::memory_order_relaxed)};
+  for (size_t slot = 0; slot < kSiteSlots; ++slot) {
+    if (sites_[slot].site.load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    CopySiteStats stats = SumSlot(slot);
+    counters.bytes += stats.bytes;
+    counters.calls += stats.calls;
+  }
+  return counters;
+}
+auto CopyTracker::SumSlot(size_t slot) const -> CopySiteStats {
+  CopySiteStats stats;
+  const CopySiteSlot& key = sites_[slot];
+  stats.site =
+      reinterpret_cast<void*>(key.site.load(std::memory_order_acquire));
+  stats.op = key.op.load(std::memory_order_relaxed);
+  for (const auto& stripe : stripes_) {
+    const CopySiteCounters& counters = stripe.sites[slot];
+    stats.bytes += counters.bytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kCopySizeBucketCount; ++i) {
+      size_t calls = counters.sizes[i].load(std::memory_order_relaxed);
+      stats.sizes[i] += calls;
+      stats.calls += calls;
+    }
+  }
+  return stats;
+}
+auto CopyTracker::GetTopSites(size_t count) const
+    -> std::vector<CopySiteStats> {
+  std::vector<CopySiteStats> result;
+  for (size_t slot = 0; slot < kSiteSlots; ++slot) {
+    if (sites_[slot].site.load(std::memory_order_acquire) == 0) {
+      continue;
+    }
+    result.push_back(SumSlot(slot));
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.bytes > rhs.bytes;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto CopyTracker::GetTopStacks(size_t count) const
+    -> std::vector<CopyStackStats> {
+  std::vector<CopyStackStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(stacks_.size());
+    for (const auto& pair : stacks_) {
+      result.push_back(pair.second);
+    }
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.bytes > rhs.bytes;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+static auto FormatBytes(size_t bytes) -> std::string {
+  constexpr double kKib = 1024.0;
+  constexpr double kMib = kKib * 1024.0;
+  constexpr double kGib = kMib * 1024.0;
+  std::array<char, 32> text{};
+  auto value = static_cast<double>(bytes);
+  if (value >= kGib) {
+    snprintf(text.data(), text.size(), "%.2f GiB", value / kGib);
+  } else if (value >= kMib) {
+    snprintf(text.data(), text.size(), "%.2f MiB", value / kMib);
+  } else if (value >= kKib) {
+    snprintf(text.data(), text.size(), "%.2f KiB", value / kKib);
+  } else {
+    snprintf(text.data(), text.size(), "%zu B", bytes);
+  }
+  return text.data();
+}
+auto CopyTracker::PrintStatus(size_t count) const -> void {
+  CopyCounters counters = GetCounters();
+  std::vector<CopySiteStats> sites = GetTopSites(count);
+  std::vector<CopyStackStats> stacks = GetTopStacks(count);
+  std::array<size_t, kCopySizeBucketCount> sizes{};
+  for (const auto& stripe : stripes_) {
+    for (const auto& site : stripe.sites) {
+      for (size_t i = 0; i < kCopySizeBucketCount; ++i) {
+        sizes[i] += site.sizes[i].load(std::memory_order_relaxed);
+      }
+    }
+  }
+  ReportSection section;
+  TRACKER_PRINT("\n\n=== Copy Profile ===\n");
+  TRACKER_PRINT("Calls: %zu, bytes: %s, large copies: %zu\n", counters.calls,
+                FormatBytes(counters.bytes).c_str(), counters.large_copies);
+  if (counters.untracked_calls != 0) {
+    TRACKER_WARNING("%zu calls from sites beyond the site table\n",
+                    counters.untracked_calls);
+  }
+  TRACKER_PRINT("Sizes:");
+  for (size_t i = 0; i < kCopySizeBucketCount; ++i) {
+    TRACKER_PRINT(" %s: %zu", CopySizeBucketName(i), sizes[i]);
+  }
+  TRACKER_PRINT("\n");
+  if (!sites.empty()) {
+    TRACKER_PRINT("\nCopy-heavy sites (by bytes):\n");
+  }
+  for (size_t i = 0; i < sites.size(); ++i) {
+    const auto& site = sites[i];
+    Dl_info dlinfo;
+    const char* symbol = "??";
+    const char* module = "??";
+    if (dladdr(site.site, &dlinfo) != 0) {
+      symbol = dlinfo.dli_sname != nullptr ? dlinfo.dli_sname : symbol;
+      module = dlinfo.dli_fname != nullptr ? dlinfo.dli_fname : module;
+    }
+    TRACKER_PRINT("[%zu] %s at %p %s (%s)\n", i, CopyOpName(site.op),
+                  site.site, symbol, module);
+    TRACKER_PRINT("    calls: %zu, bytes: %s, avg: %.1f B, sizes:", site.calls,
+                  FormatBytes(site.bytes).c_str(),
+                  site.calls == 0 ? 0.0
+                                  : static_cast<double>(site.bytes) /
+                                        static_cast<double>(site.calls));
+    for (size_t bucket = 0; bucket < kCopySizeBucketCount; ++bucket) {
+      if (site.sizes[bucket] != 0) {
+        TRACKER_PRINT(" %s: %zu", CopySizeBucketName(bucket),
+                      site.sizes[bucket]);
+      }
+    }
+    TRACKER_PRINT("\n");
+  }
+  if (!stacks.empty()) {
+    TRACKER_PRINT("\nLarge copies (>= %s) by stack:\n",
+                  FormatBytes(GetStackThreshold()).c_str());
+  }
+  for (size_t i = 0; i < stacks.size(); ++i) {
+    const auto& stack = stacks[i];
+    TRACKER_PRINT("[%zu] %s: calls: %zu, bytes: %s, max: %s\n", i,
+                  CopyOpName(stack.op), stack.calls,
+                  FormatBytes(stack.bytes).c_str(),
+                  FormatBytes(stack.max_bytes).c_str());
+    size_t frame_index = 0;
+    for (void* frame : stack.callstack) {
+      Dl_info dlinfo;
+      if (dladdr(frame, &dlinfo) == 0) {
+        TRACKER_PRINT("    #%zu %p\n", frame_index++, frame);
+        continue;
+      }
+      if (dlinfo.dli_fname != nullptr &&
+          strstr(dlinfo.dli_fname, "libnv_detector") != nullptr) {
+        continue;
+      }
+      TRACKER_PRINT("    #%zu %p %s (%s)\n", frame_index++, frame,
+                    dlinfo.dli_sname != nullptr ? dlinfo.dli_sname : "??",
+                    dlinfo.dli_fname != nullptr ? dlinfo.dli_fname : "??");
+    }
+  }
+  TRACKER_PRINT("===========================\n");
+}
+}  // namespace tracker
+// Shared tail of every copy hook. Small copies only touch the site table;
+// the overhead accounting and the unwind are paid above the threshold.
+static auto RecordCopy(CopyOp op, void* site, size_t bytes) -> void {
+  auto& tracker = tracker::Instance();
+  if (bytes < tracker.GetStackThreshold()) {
+    tracker::OverheadAccounting::Instance().CountCall(
+        tracker::HookKindFor(op));
+    tracker.RecordCopy(op, site, bytes);
+    return;
+  }
+  tracker::HookScope scope(tracker::HookKindFor(op));
+  tracker.RecordCopy(op, site, bytes);
+  tracker.RecordLargeCopy(op, bytes);
+}
+static auto HookedMemcpy(void* dst, const void* src, size_t len) -> void* {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  void* result = memcpy(dst, src, len);
+  RecordCopy(CopyOp::kMemcpy, site, len);
+  return result;
+}
+static auto HookedMemcpyChk(void* dst, const void* src, size_t len,
+                            size_t dstlen) -> void* {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  void* result = __memcpy_chk(dst, src, len, dstlen);
+  RecordCopy(CopyOp::kMemcpy, site, len);
+  return result;
+}
+static auto HookedMemmove(void* dst, const void* src, size_t len) -> void* {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  void* result = memmove(dst, src, len);
+  RecordCopy(CopyOp::kMemmove, site, len);
+  return result;
+}
+static auto HookedMemmoveChk(void* dst, const void* src, size_t len,
+                             size_t dstlen) -> void* {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  void* result = __memmove_chk(dst, src, len, dstlen);
+  RecordCopy(CopyOp::kMemmove, site, len);
+  return result;
+}
+static auto HookedMemset(void* dst, int value, size_t len) -> void* {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  void* result = memset(dst, value, len);
+  RecordCopy(CopyOp::kMemset, site, len);
+  return result;
+}
+static auto HookedMemsetChk(void* dst, int value, size_t len, size_t dstlen)
+    -> void* {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  void* result = __memset_chk(dst, value, len, dstlen);
+  RecordCopy(CopyOp::kMemset, site, len);
+  return result;
+}
+// stpcpy gives the copied length without a second pass over the string.
+static auto HookedStrcpy(char* dst, const char* src) -> char* {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  char* end = stpcpy(dst, src);
+  RecordCopy(CopyOp::kStrcpy, site, static_cast<size_t>(end - dst) + 1);
+  return dst;
+}
+static auto HookedStrcpyChk(char* dst, const char* src, size_t dstlen)
+    -> char* {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  char* end = __stpcpy_chk(dst, src, dstlen);
+  RecordCopy(CopyOp::kStrcpy, site, static_cast<size_t>(end - dst) + 1);
+  return dst;
+}
+static auto HookedStrlen(const char* str) -> size_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  size_t result = strlen(str);
+  RecordCopy(CopyOp::kStrlen, site, result);
+  return result;
+}
+class CopyHook {
+ public:
+  explicit CopyHook(std::string lib_path) : lib_path_(std::move(lib_path)) {}
+  ~CopyHook() = default;
+  auto Start() -> void;
+
+ private:
+  std::string lib_path_;
+  std::unique_ptr<PltHook> hook_;
+};
+auto CopyHook::Start() -> void {
+  hook_ = PltHook::Create(lib_path_.c_str());
+  try {
+    std::vector<std::string> hooked_functions;
+    auto try_hook = [&](const char* symbol, void* hook_func) {
+      if (hook_->ReplaceFunction(symbol, hook_func, nullptr) ==
+          PltHook::ErrorCode::kSuccess) {
+        hooked_functions.emplace_back(symbol);
+      }
+    };
+    try_hook("memcpy", reinterpret_cast<void*>(&HookedMemcpy));
+    try_hook("__memcpy_chk", reinterpret_cast<void*>(&HookedMemcpyChk));
+    try_hook("memmove", reinterpret_cast<void*>(&HookedMemmove));
+    try_hook("__memmove_chk", reinterpret_cast<void*>(&HookedMemmoveChk));
+    try_hook("memset", reinterpret_cast<void*>(&HookedMemset));
+    try_hook("__memset_chk", reinterpret_cast<void*>(&HookedMemsetChk));
+    try_hook("strcpy", reinterpret_cast<void*>(&HookedStrcpy));
+    try_hook("__strcpy_chk", reinterpret_cast<void*>(&HookedStrcpyChk));
+    try_hook("strlen", reinterpret_cast<void*>(&HookedStrlen));
+    tracker::ReportSection section;
+    auto& output = tracker::OutputControl::Instance();
+    output.PrintColored(tracker::Color::kGreen, tracker::Color::kReset,
+                        "Hooked copy functions: ");
+    for (size_t i = 0; i < hooked_functions.size(); ++i) {
+      TRACKER_PRINT("%s", hooked_functions[i].c_str());
+      if (i < hooked_functions.size() - 1) {
+        TRACKER_PRINT(", ");
+      }
+    }
+    TRACKER_PRINT("\n");
+  } catch (const std::exception& e) {
+    TRACKER_ERROR("Error starting copy tracking: %s", e.what());
+  }
+}
+class CopyDetectImpl {
+ public:
+  CopyDetectImpl() = default;
+  ~CopyDetectImpl() = default;
+  auto Register(const std::string& lib_name) -> void;
+  auto RegisterMain() -> void;
+  auto Start() -> void;
+  auto Detect() -> void;
+  auto GetCounters() const -> CopyCounters;
+  auto GetTopSites(size_t count) const -> std::vector<CopySiteStats>;
+  auto GetTopStacks(size_t count) const -> std::vector<CopyStackStats>;
+  auto PrintTopSites(size_t count) -> void;
+
+ private:
+  std::vector<std::unique_ptr<CopyHook>> hooks_;
+};
+auto CopyDetectImpl::Register(const std::string& lib_name) -> void {
+  hooks_.emplace_back(std::make_unique<CopyHook>(lib_name));
+}
+auto CopyDetectImpl::RegisterMain() -> void {
+  hooks_.emplace_back(std::make_unique<CopyHook>(std::string()));
+}
+auto CopyDetectImpl::Start() -> void {
+  tracker::Instance();
+  tracker::OverheadAccounting::Instance().Start();
+  for (auto& hook : hooks_) {
+    hook->Start();
+  }
+}
+auto CopyDetectImpl::Detect() -> void {
+  constexpr size_t kReportCount = 10;
+  tracker::Instance().PrintStatus(kReportCount);
+}
+auto CopyDetectImpl::GetCounters() const -> CopyCounters {
+  return tracker::Instance().GetCounters();
+}
+auto CopyDetectImpl::GetTopSites(size_t count) const
+    -> std::vector<CopySiteStats> {
+  return tracker::Instance().GetTopSites(count);
+}
+auto CopyDetectImpl::GetTopStacks(size_t count) const
+    -> std::vector<CopyStackStats> {
+  return tracker::Instance().GetTopStacks(count);
+}
+auto CopyDetectImpl::PrintTopSites(size_t count) -> void {
+  tracker::Instance().PrintStatus(count);
+}
+CopyDetect::CopyDetect() : impl_(std::make_unique<CopyDetectImpl>()) {}
+CopyDetect::~CopyDetect() = default;
+auto CopyDetect::Register(const std::string& lib_name) -> void {
+  impl_->Register(lib_name);
+}
+auto CopyDetect::RegisterMain() -> void { impl_->RegisterMain(); }
+auto CopyDetect::Start() -> void { impl_->Start(); }
+auto CopyDetect::Detect() -> void { impl_->Detect(); }
+auto CopyDetect::GetCounters() const -> CopyCounters {
+  return impl_->GetCounters();
+}
+auto CopyDetect::SetStackThreshold(size_t bytes) -> void {
+  tracker::Instance().SetStackThreshold(bytes);
+}
+auto CopyDetect::GetStackThreshold() const -> size_t {
+  return tracker::Instance().GetStackThreshold();
+}
+auto CopyDetect::GetTopSites(size_t count) const
+    -> std::vector<CopySiteStats> {
+  return impl_->GetTopSites(count);
+}
+auto CopyDetect::GetTopStacks(size_t count) const
+    -> std::vector<CopyStackStats> {
+  return impl_->GetTopStacks(count);
+}
+auto CopyDetect::PrintTopSites(size_t count) -> void {
+  impl_->PrintTopSites(count);
+}
@@ -1,11 +1,23 @@
 #include "detector.h"
 
+#include <unistd.h>
+
 #include <ctime>
 #include <string>
+#include <vector>
 
+#include "blocking_detect.h"
+#include "copy_detect.h"
+#include "detector_service.h"
+#include "exception_detect.h"
+#include "fd_detect.h"
+#include "function_trace.h"
+#include "io_detect.h"
 #include "lock_detect.h"
 #include "memory_detect.h"
+#include "thread_detect.h"
 #include "output_control.h"
+#include "overhead.h"
 auto GetFilePath(std::string work_dir) -> std::string {
   std::string output_file_name =
       work_dir + "/detector_" + std::to_string(time(nullptr)) + ".log";
@@ -13,10 +25,14 @@ auto GetFilePath(std::string work_dir) -> std::string {
 }
 extern "C" {
 static DetectorOption detector_option = kDetectorOptionMemoryLock;
+// constinit: DetectorInit may run from a library constructor (see
+// autostart.cpp) before this file's dynamic initializers.
+static constinit std::string detector_work_dir;
 __attribute__((visibility("default"))) auto DetectorInit(
     const char* work_dir, DetectorOption detect_option,
     OutputOption output_option) -> void {
   detector_option = detect_option;
+  detector_work_dir = work_dir;
   std::string output_file_name = GetFilePath(work_dir);
   tracker::OutputControl::Instance().Configure(output_option, output_file_name);
 }
@@ -27,6 +43,24 @@ __attribute__((visibility("default"))) auto DetectorStart(void) -> void {
   if ((detector_option & kDetectorOptionLock) != 0) {
     LockDetect::GetInstance().Start();
   }
+  if ((detector_option & kDetectorOptionIo) != 0) {
+    IoDetect::GetInstance().Start();
+  }
+  if ((detector_option & kDetectorOptionThread) != 0) {
+    ThreadDetect::GetInstance().Start();
+  }
+  if ((detector_option & kDetectorOptionBlocking) != 0) {
+    BlockingDetect::GetInstance().Start();
+  }
+  if ((detector_option & kDetectorOptionFd) != 0) {
+    FdDetect::GetInstance().Start();
+  }
+  if ((detector_option & kDetectorOptionCopy) != 0) {
+    CopyDetect::GetInstance().Start();
+  }
+  if ((detector_option & kDetectorOptionException) != 0) {
+    ExceptionDetect::GetInstance().Start();
+  }
 }
 __attribute__((visibility("default"))) auto DetectorDetect(void) -> void {
   if ((detector_option & kDetectorOptionMemory) != 0) {
@@ -35,25 +69,212 @@ __attribute__((visibility("default"))) auto DetectorDetect(void) -> void {
   if ((detector_option & kDetectorOptionLock) != 0) {
     LockDetect::GetInstance().Detect();
   }
+  if ((detector_option & kDetectorOptionIo) != 0) {
+    IoDetect::GetInstance().Detect();
+  }
+  if ((detector_option & kDetectorOptionThread) != 0) {
+    ThreadDetect::GetInstance().Detect();
+  }
+  if ((detector_option & kDetectorOptionBlocking) != 0) {
+    BlockingDetect::GetInstance().Detect();
+  }
+  if ((detector_option & kDetectorOptionFd) != 0) {
+    FdDetect::GetInstance().Detect();
+  }
+  if ((detector_option & kDetectorOptionCopy) != 0) {
+    CopyDetect::GetInstance().Detect();
+  }
+  if ((detector_option & kDetectorOptionException) != 0) {
+    ExceptionDetect::GetInstance().Detect();
+  }
+  FunctionTrace::GetInstance().Detect();
+  tracker::OverheadAccounting::Instance().Print(detector_option);
 }
 __attribute__((visibility("default"))) auto DetectorRegister(
     const char* lib_name) -> void {
   if (lib_name == nullptr) {
     return;
   }
+  FunctionTrace::GetInstance().Register(lib_name);
   if ((detector_option & kDetectorOptionMemory) != 0) {
     MemoryDetect::GetInstance().Register(lib_name);
   }
   if ((detector_option & kDetectorOptionLock) != 0) {
     LockDetect::GetInstance().Register(lib_name);
   }
+  if ((detector_option & kDetectorOptionIo) != 0) {
+    IoDetect::GetInstance().Register(lib_name);
+  }
+  if ((detector_option & kDetectorOptionThread) != 0) {
+    ThreadDetect::GetInstance().Register(lib_name);
+  }
+  if ((detector_option & kDetectorOptionBlocking) != 0) {
+    BlockingDetect::GetInstance().Register(lib_name);
+  }
+  if ((detector_option & kDetectorOptionFd) != 0) {
+    FdDetect::GetInstance().Register(lib_name);
+  }
+  if ((detector_option & kDetectorOptionCopy) != 0) {
+    CopyDetect::GetInstance().Register(lib_name);
+  }
+  if ((detector_option & kDetectorOptionException) != 0) {
+    ExceptionDetect::GetInstance().Register(lib_name);
+  }
 }
 __attribute__((visibility("default"))) auto DetectorRegisterMain(void) -> void {
+  FunctionTrace::GetInstance().RegisterMain();
   if ((detector_option & kDetectorOptionMemory) != 0) {
     MemoryDetect::GetInstance().Register("");
   }
   if ((detector_option & kDetectorOptionLock) != 0) {
     LockDetect::GetInstance().Register("");
   }
+  if ((detector_option & kDetectorOptionIo) != 0) {
+    IoDetect::GetInstance().Register("");
+  }
+  if ((detector_option & kDetectorOptionThread) != 0) {
+    ThreadDetect::GetInstance().Register("");
+  }
+  if ((detector_option & kDetectorOptionBlocking) != 0) {
+    BlockingDetect::GetInstance().Register("");
+  }
+  if ((detector_option & kDetectorOptionFd) != 0) {
+    FdDetect::GetInstance().Register("");
+  }
+  if ((detector_option & kDetectorOptionCopy) != 0) {
+    CopyDetect::GetInstance().Register("");
+  }
+  if ((detector_option & kDetectorOptionException) != 0) {
+    ExceptionDetect::GetInstance().Register("");
+  }
+}
+__attribute__((visibility("default"))) auto DetectorSetLogRotation(
+    size_t max_file_bytes, size_t max_files) -> void {
+  tracker::OutputControl::Instance().SetRotation(max_file_bytes, max_files);
+}
+__attribute__((visibility("default"))) auto DetectorStartPeriodic(
+    unsigned int interval_ms, DetectorOption flags) -> void {
+  DetectorService::GetInstance().StartPeriodic(interval_ms,
+                                               detector_option & flags);
+}
+__attribute__((visibility("default"))) auto DetectorEnableSignalDump(
+    int signal_number) -> void {
+  DetectorService::GetInstance().EnableSignalDump(signal_number,
+                                                  detector_option);
+}
+__attribute__((visibility("default"))) auto DetectorEnableControlSocket(void)
+    -> void {
+  std::string path = (detector_work_dir.empty() ? "." : detector_work_dir) +
+                     "/nv_detector_" +
+                     std::to_string(getpid()) + ".sock";
+  DetectorService::GetInstance().EnableControlSocket(path, detector_option);
+}
+__attribute__((visibility("default"))) auto DetectorStartPrometheusExport(
+    unsigned int interval_ms) -> void {
+  std::string path = (detector_work_dir.empty() ? "." : detector_work_dir) +
+                     "/nv_detector_" + std::to_string(getpid()) + ".prom";
+  DetectorService::GetInstance().StartPrometheusExport(path, interval_ms,
+                                                       detector_option);
+}
+__attribute__((visibility("default"))) auto DetectorStartStatsSegment(
+    unsigned int interval_ms) -> void {
+  DetectorService::GetInstance().StartStatsSegment(interval_ms,
+                                                   detector_option);
+}
+__attribute__((visibility("default"))) auto DetectorSetSampling(
+    unsigned int memory_period, unsigned int lock_stack_period) -> void {
+  if ((detector_option & kDetectorOptionMemory) != 0) {
+    MemoryDetect::GetInstance().SetSamplePeriod(memory_period);
+  }
+  if ((detector_option & kDetectorOptionLock) != 0) {
+    LockDetect::GetInstance().SetStackSamplePeriod(lock_stack_period);
+  }
+}
+__attribute__((visibility("default"))) auto DetectorSetOverheadBudget(
+    double cpu_percent) -> void {
+  DetectorService::GetInstance().StartGovernor(cpu_percent, detector_option);
+}
+__attribute__((visibility("default"))) auto DetectorStop(void) -> void {
+  DetectorService::GetInstance().Stop();
+}
+__attribute__((visibility("default"))) auto DetectorTraceFunction(
+    const char* symbol) -> size_t {
+  if (symbol == nullptr) {
+    return 0;
+  }
+  return FunctionTrace::GetInstance().TraceFunction(symbol);
+}
+__attribute__((visibility("default"))) auto DetectorStartCallCensus(void)
+    -> size_t {
+  return FunctionTrace::GetInstance().StartCensus();
+}
+__attribute__((visibility("default"))) auto DetectorSetCopyStackThreshold(
+    size_t bytes) -> void {
+  CopyDetect::GetInstance().SetStackThreshold(bytes);
+}
+__attribute__((visibility("default"))) auto DetectorGetMemoryStats(
+    NvMemStats* stats) -> int {
+  if (stats == nullptr || (detector_option & kDetectorOptionMemory) == 0) {
+    return -1;
+  }
+  MemoryCounters counters = MemoryDetect::GetInstance().GetCounters();
+  stats->total_allocated = counters.total_allocated;
+  stats->total_freed = counters.total_freed;
+  stats->active_allocations = counters.active_allocations;
+  stats->active_bytes = counters.active_bytes;
+  return 0;
+}
+__attribute__((visibility("default"))) auto DetectorGetTopSites(
+    NvAllocSite* sites, size_t count) -> size_t {
+  if (sites == nullptr || (detector_option & kDetectorOptionMemory) == 0) {
+    return 0;
+  }
+  std::vector<AllocationSite> top =
+      MemoryDetect::GetInstance().GetTopSites(count);
+  for (size_t i = 0; i < top.size(); ++i) {
+    sites[i] = {top[i].site, top[i].bytes, top[i].count};
+  }
+  return top.size();
+}
+__attribute__((visibility("default"))) auto DetectorGetLockStats(
+    NvLockStats* stats) -> int {
+  if (stats == nullptr || (detector_option & kDetectorOptionLock) == 0) {
+    return -1;
+  }
+  LockCounters counters = LockDetect::GetInstance().GetCounters();
+  stats->acquisitions = counters.acquisitions;
+  stats->contended_acquisitions = counters.contended_acquisitions;
+  stats->deadlocks_detected = counters.deadlocks_detected;
+  stats->total_wait_ns = counters.total_wait_ns;
+  return 0;
+}
+__attribute__((visibility("default"))) auto DetectorGetTopLocks(
+    NvLockEntry* locks, size_t count) -> size_t {
+  if (locks == nullptr || (detector_option & kDetectorOptionLock) == 0) {
+    return 0;
+  }
+  std::vector<LockStats> top = LockDetect::GetInstance().GetLockStats(count);
+  for (size_t i = 0; i < top.size(); ++i) {
+    locks[i] = {top[i].lock_addr, top[i].acquisitions,
+                top[i].contended_acquisitions, top[i].wait_ns,
+                top[i].max_wait_ns};
+  }
+  return top.size();
+}
+__attribute__((visibility("default"))) auto DetectorGetOverheadStats(
+    NvOverheadStats* stats) -> int {
+  if (stats == nullptr) {
+    return -1;
+  }
+  tracker::OverheadCounters counters =
+      tracker::OverheadAccounting::Instance().GetCounters(detector_option);
+  stats->hooked_calls = counters.hooked_calls;
+  stats->overhead_ns = counters.overhead_ns;
+  stats->metadata_bytes = counters.metadata_bytes;
+  stats->wall_percent = counters.wall_percent;
+  stats->cpu_percent = counters.cpu_percent;
+  stats->unwind_ns = counters.unwind_ns;
+  stats->table_ns = counters.table_ns;
+  return 0;
 }
 }
@@ -0,0 +1,632 @@
+#include "detector_service.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "blocking_detect.h"
+#include "control_socket.h"
+#include "copy_detect.h"
+#include "detector.h"
+#include "exception_detect.h"
+#include "fd_detect.h"
+#include "function_trace.h"
+#include "io_detect.h"
+#include "lock_detect.h"
+#include "memory_detect.h"
+#include "thread_detect.h"
+#include "output_control.h"
+#include "overhead.h"
+#include "prometheus_export.h"
+#include "stats_segment.h"
+// State shared with the signal handler. Only lock-free atomics live here.
+static std::atomic<int> g_dump_fd = -1;
+static std::atomic<int> g_dump_option = 0;
+static std::atomic<bool> g_dump_pending = false;
+static auto AppendText(std::array<char, 256>& buf, size_t& len,
+                       const char* text) -> void {
+  while (*text != '\0' && len < buf.size()) {
+    buf[len++] = *text++;
+  }
+}
+static auto AppendDecimal(std::array<char, 256>& buf, size_t& len,
+                          uint64_t value) -> void {
+  constexpr size_t kMaxDigits = 20;
+  constexpr uint64_t kBase = 10;
+  std::array<char, kMaxDigits> digits{};
+  size_t count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + value % kBase);
+    value /= kBase;
+  } while (value != 0 && count < kMaxDigits);
+  while (count > 0 && len < buf.size()) {
+    buf[len++] = digits[--count];
+  }
+}
+// Emergency path: formats the lock-free counters by hand and emits them with
+// write(2) only, so it is async-signal-safe and works even when the service
+// thread is wedged.
+static auto WriteRawStats() -> void {
+  std::array<char, 256> buf{};
+  size_t len = 0;
+  int option = g_dump_option.load(std::memory_order_relaxed);
+  AppendText(buf, len, "nv_detector raw stats: pid=");
+  AppendDecimal(buf, len, static_cast<uint64_t>(getpid()));
+  if ((option & kDetectorOptionMemory) != 0) {
+    MemoryCounters counters = MemoryDetect::GetInstance().GetCounters();
+    AppendText(buf, len, " allocated=");
+    AppendDecimal(buf, len, counters.total_allocated);
+    AppendText(buf, len, " freed=");
+    AppendDecimal(buf, len, counters.total_freed);
+    AppendText(buf, len, " active=");
+    AppendDecimal(buf, len, counters.active_allocations);
+  }
+  if ((option & kDetectorOptionLock) != 0) {
+    LockCounters counters = LockDetect::GetInstance().GetCounters();
+    AppendText(buf, len, " lock_acquisitions=");
+    AppendDecimal(buf, len, counters.acquisitions);
+    AppendText(buf, len, " contended=");
+    AppendDecimal(buf, len, counters.contended_acquisitions);
+    AppendText(buf, len, " deadlocks=");
+    AppendDecimal(buf, len, counters.deadlocks_detected);
+  }
+  AppendText(buf, len, "\n");
+  if (write(STDERR_FILENO, buf.data(), len) < 0) {
+    // Nothing useful can be done about a failed write in a signal handler
+  }
+  int output_fd = tracker::OutputControl::Instance().GetOutputFd();
+  if (output_fd >= 0 && write(output_fd, buf.data(), len) < 0) {
+    // Same as above
+  }
+}
+// Only pokes the service thread's eventfd. If no service thread is listening
+// or the previous request is still pending, fall back to the raw dump.
+static auto HandleDumpSignal(int /*signal_number*/) -> void {
+  int saved_errno = errno;
+  int fd = g_dump_fd.load(std::memory_order_acquire);
+  if (fd < 0 || g_dump_pending.exchange(true, std::memory_order_acq_rel)) {
+    WriteRawStats();
+  } else {
+    uint64_t value = 1;
+    if (write(fd, &value, sizeof(value)) < 0) {
+      WriteRawStats();
+    }
+  }
+  errno = saved_errno;
+}
+static auto DrainEventFd(int fd) -> void {
+  uint64_t value = 0;
+  if (read(fd, &value, sizeof(value)) < 0) {
+    // EAGAIN on a spurious wakeup; nothing to drain
+  }
+}
+class DetectorServiceImpl {
+ public:
+  DetectorServiceImpl() = default;
+  ~DetectorServiceImpl() { Stop(); }
+  auto StartPeriodic(unsigned int interval_ms, int detect_option) -> void;
+  auto EnableSignalDump(int signal_number, int detect_option) -> void;
+  auto EnableControlSocket(const std::string& path, int detect_option)
+      -> void;
+  auto StartPrometheusExport(const std::string& path, unsigned int interval_ms,
+                             int detect_option) -> void;
+  auto StartStatsSegment(unsigned int interval_ms, int detect_option) -> void;
+  auto StartGovernor(double budget_percent, int detect_option) -> void;
+  auto Stop() -> void;
+
+ private:
+  auto EnsureRunning() -> bool;
+  auto Wake() const -> void;
+  auto Run() -> void;
+  auto HandleCommand(const std::string& line) -> std::string;
+  std::mutex mutex_;
+  std::thread thread_;
+  int wake_fd_ = -1;
+  int dump_fd_ = -1;
+  bool dump_fd_pinned_ = false;
+  int signal_number_ = 0;
+  struct sigaction old_action_ {};
+  std::atomic<bool> stopping_ = false;
+  std::atomic<unsigned int> interval_ms_ = 0;
+  std::atomic<int> periodic_option_ = 0;
+  // Written by EnableControlSocket, picked up by the service thread on wake.
+  std::mutex config_mutex_;
+  std::string control_path_;
+  int control_option_ = 0;
+  std::string export_path_;
+  int export_option_ = 0;
+  std::atomic<unsigned int> export_interval_ms_ = 0;
+  std::unique_ptr<tracker::PrometheusExporter> exporter_;
+  int segment_option_ = 0;
+  std::atomic<unsigned int> segment_interval_ms_ = 0;
+  std::unique_ptr<tracker::StatsSegment> stats_segment_;
+  double governor_budget_ = 0.0;
+  int governor_option_ = 0;
+  std::atomic<unsigned int> governor_interval_ms_ = 0;
+  std::unique_ptr<tracker::OverheadGovernor> governor_;
+  tracker::ControlSocket control_socket_{
+      [this](const std::string& line) { return HandleCommand(line); }};
+};
+auto DetectorServiceImpl::EnsureRunning() -> bool {
+  if (thread_.joinable()) {
+    return true;
+  }
+  wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (dump_fd_ < 0) {
+    dump_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  } else {
+    DrainEventFd(dump_fd_);
+  }
+  if (wake_fd_ < 0 || dump_fd_ < 0) {
+    TRACKER_ERROR("Failed to create detector service eventfd\n");
+    return false;
+  }
+  stopping_.store(false);
+  thread_ = std::thread(&DetectorServiceImpl::Run, this);
+  return true;
+}
+auto DetectorServiceImpl::Wake() const -> void {
+  uint64_t value = 1;
+  if (write(wake_fd_, &value, sizeof(value)) < 0) {
+    // The eventfd counter cannot overflow here; nothing to recover
+  }
+}
+auto DetectorServiceImpl::StartPeriodic(unsigned int interval_ms,
+                                        int detect_option) -> void {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (interval_ms == 0 || !EnsureRunning()) {
+    return;
+  }
+  periodic_option_.store(detect_option);
+  interval_ms_.store(interval_ms);
+  Wake();
+}
+auto DetectorServiceImpl::EnableSignalDump(int signal_number,
+                                           int detect_option) -> void {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (signal_number_ != 0 || !EnsureRunning()) {
+    return;
+  }
+  // Construct the detectors, and with them their trackers, up front; the
+  // handler must never be the first caller of a function-local static.
+  if ((detect_option & kDetectorOptionMemory) != 0) {
+    MemoryDetect::GetInstance();
+  }
+  if ((detect_option & kDetectorOptionLock) != 0) {
+    LockDetect::GetInstance();
+  }
+  g_dump_option.store(detect_option);
+  g_dump_pending.store(false);
+  g_dump_fd.store(dump_fd_, std::memory_order_release);
+  struct sigaction action {};
+  action.sa_handler = HandleDumpSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(signal_number, &action, &old_action_) != 0) {
+    g_dump_fd.store(-1);
+    TRACKER_ERROR("Failed to install handler for signal %d\n", signal_number);
+    return;
+  }
+  signal_number_ = signal_number;
+  dump_fd_pinned_ = true;
+}
+auto DetectorServiceImpl::EnableControlSocket(const std::string& path,
+                                              int detect_option) -> void {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!EnsureRunning()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> config_lock(config_mutex_);
+    control_path_ = path;
+    control_option_ = detect_option;
+  }
+  Wake();
+}
+auto DetectorServiceImpl::StartPrometheusExport(const std::string& path,
+                                                unsigned int interval_ms,
+                                                int detect_option) -> void {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (interval_ms == 0 || !EnsureRunning()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> config_lock(config_mutex_);
+    if (!export_path_.empty()) {
+      return;
+    }
+    export_path_ = path;
+    export_option_ = detect_option;
+  }
+  export_interval_ms_.store(interval_ms);
+  Wake();
+}
+auto DetectorServiceImpl::StartStatsSegment(unsigned int interval_ms,
+                                            int detect_option) -> void {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (interval_ms == 0 || !EnsureRunning()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> config_lock(config_mutex_);
+    segment_option_ = detect_option;
+  }
+  segment_interval_ms_.store(interval_ms);
+  Wake();
+}
+auto DetectorServiceImpl::StartGovernor(double budget_percent,
+                                        int detect_option) -> void {
+  constexpr unsigned int kGovernorIntervalMs = 1000;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (budget_percent <= 0.0 || !EnsureRunning()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> config_lock(config_mutex_);
+    if (governor_budget_ > 0.0) {
+      return;
+    }
+    governor_budget_ = budget_percent;
+    governor_option_ = detect_option;
+  }
+  governor_interval_ms_.store(kGovernorIntervalMs);
+  Wake();
+}
+auto DetectorServiceImpl::Stop() -> void {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (signal_number_ != 0) {
+    sigaction(signal_number_, &old_action_, nullptr);
+    signal_number_ = 0;
+  }
+  g_dump_fd.store(-1, std::memory_order_release);
+  if (!thread_.joinable()) {
+    return;
+  }
+  stopping_.store(true);
+  Wake();
+  thread_.join();
+  close(wake_fd_);
+  wake_fd_ = -1;
+  // A handler on another thread may have loaded g_dump_fd just before it
+  // was cleared; closing would let its write hit a reused descriptor. Once
+  // a handler was installed, the eventfd stays open and is reused.
+  if (!dump_fd_pinned_) {
+    close(dump_fd_);
+    dump_fd_ = -1;
+  }
+  interval_ms_.store(0);
+  export_interval_ms_.store(0);
+  exporter_.reset();
+  segment_interval_ms_.store(0);
+  stats_segment_.reset();
+  governor_interval_ms_.store(0);
+  governor_.reset();
+  std::lock_guard<std::mutex> config_lock(config_mutex_);
+  control_path_.clear();
+  export_path_.clear();
+  governor_budget_ = 0.0;
+}
+// Fixed-rate timer driven by the poll loop; re-arms whenever the configured
+// interval changes and skips ticks that were missed entirely.
+struct IntervalTimer {
+  unsigned int interval_ms = 0;
+  std::chrono::steady_clock::time_point next{};
+  auto Update(unsigned int configured_ms) -> void {
+    if (configured_ms != interval_ms) {
+      interval_ms = configured_ms;
+      next = std::chrono::steady_clock::now() +
+             std::chrono::milliseconds(interval_ms);
+    }
+  }
+  [[nodiscard]] auto TimeoutMs() const -> int {
+    if (interval_ms == 0) {
+      return -1;
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        next - std::chrono::steady_clock::now());
+    return static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+  }
+  auto Expired() -> bool {
+    auto now = std::chrono::steady_clock::now();
+    if (interval_ms == 0 || now < next) {
+      return false;
+    }
+    next += std::chrono::milliseconds(interval_ms);
+    if (next < now) {
+      next = now + std::chrono::milliseconds(interval_ms);
+    }
+    return true;
+  }
+};
+// Runs at the lowest scheduling priority and sleeps in poll() until a timer
+// is due, a dump is requested, a control client speaks, or the
+// configuration changes.
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto DetectorServiceImpl::Run() -> void {
+  constexpr int kLowestNice = 19;
+  pthread_setname_np(pthread_self(), "nv_detector");
+  setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), kLowestNice);
+  std::vector<pollfd> fds;
+  IntervalTimer report_timer;
+  IntervalTimer export_timer;
+  IntervalTimer segment_timer;
+  IntervalTimer governor_timer;
+  while (!stopping_.load()) {
+    report_timer.Update(interval_ms_.load());
+    export_timer.Update(export_interval_ms_.load());
+    segment_timer.Update(segment_interval_ms_.load());
+    governor_timer.Update(governor_interval_ms_.load());
+    int timeout_ms = -1;
+    for (int timer_timeout :
+         {report_timer.TimeoutMs(), export_timer.TimeoutMs(),
+          segment_timer.TimeoutMs(), governor_timer.TimeoutMs()}) {
+      if (timer_timeout >= 0 &&
+          (timeout_ms < 0 || timer_timeout < timeout_ms)) {
+        timeout_ms = timer_timeout;
+      }
+    }
+    fds.assign({{wake_fd_, POLLIN, 0}, {dump_fd_, POLLIN, 0}});
+    control_socket_.AppendPollFds(fds);
+    if (poll(fds.data(), fds.size(), timeout_ms) < 0 && errno != EINTR) {
+      break;
+    }
+    if ((fds[0].revents & POLLIN) != 0) {
+      DrainEventFd(wake_fd_);
+      std::lock_guard<std::mutex> config_lock(config_mutex_);
+      if (!control_path_.empty() && !control_socket_.IsListening()) {
+        control_socket_.Listen(control_path_);
+      }
+      if (!export_path_.empty() && !exporter_) {
+        exporter_ = std::make_unique<tracker::PrometheusExporter>(
+            export_option_);
+      }
+      if (segment_interval_ms_.load() != 0 && !stats_segment_) {
+        stats_segment_ =
+            std::make_unique<tracker::StatsSegment>(segment_option_);
+        if (!stats_segment_->Create()) {
+          segment_interval_ms_.store(0);
+        }
+      }
+      if (governor_interval_ms_.load() != 0 && !governor_) {
+        governor_ = std::make_unique<tracker::OverheadGovernor>(
+            governor_budget_, governor_option_);
+      }
+      continue;
+    }
+    control_socket_.HandlePollFds(fds.data() + 2, fds.size() - 2);
+    if ((fds[1].revents & POLLIN) != 0) {
+      DrainEventFd(dump_fd_);
+      int option = g_dump_option.load();
+      if ((option & kDetectorOptionMemory) != 0) {
+        MemoryDetect::GetInstance().Detect();
+      }
+      if ((option & kDetectorOptionLock) != 0) {
+        LockDetect::GetInstance().Detect();
+      }
+      if ((option & kDetectorOptionIo) != 0) {
+        IoDetect::GetInstance().Detect();
+      }
+      if ((option & kDetectorOptionThread) != 0) {
+        ThreadDetect::GetInstance().Detect();
+      }
+      if ((option & kDetectorOptionBlocking) != 0) {
+        BlockingDetect::GetInstance().Detect();
+      }
+      if ((option & kDetectorOptionFd) != 0) {
+        FdDetect::GetInstance().Detect();
+      }
+      if ((option & kDetectorOptionCopy) != 0) {
+        CopyDetect::GetInstance().Detect();
+      }
+      if ((option & kDetectorOptionException) != 0) {
+        ExceptionDetect::GetInstance().Detect();
+      }
+      g_dump_pending.store(false, std::memory_order_release);
+    }
+    if (report_timer.Expired()) {
+      int option = periodic_option_.load();
+      if ((option & kDetectorOptionMemory) != 0) {
+        MemoryDetect::GetInstance().DetectIncremental();
+      }
+      if ((option & kDetectorOptionLock) != 0) {
+        LockDetect::GetInstance().DetectIncremental();
+      }
+    }
+    if (export_timer.Expired() && exporter_) {
+      exporter_->WriteFile(export_path_);
+    }
+    if (segment_timer.Expired() && stats_segment_) {
+      stats_segment_->Publish();
+    }
+    if (governor_timer.Expired() && governor_) {
+      governor_->Update();
+    }
+  }
+  control_socket_.Close();
+}
+// Control protocol: one command per line, answered from tracker snapshots.
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto DetectorServiceImpl::HandleCommand(const std::string& line)
+    -> std::string {
+  constexpr size_t kDefaultTopCount = 20;
+  constexpr unsigned int kDefaultIntervalMs = 1000;
+  std::istringstream stream(line);
+  std::string command;
+  std::string argument;
+  stream >> command >> argument;
+  int option = 0;
+  {
+    std::lock_guard<std::mutex> config_lock(config_mutex_);
+    option = control_option_;
+  }
+  bool memory = (option & kDetectorOptionMemory) != 0;
+  bool lock = (option & kDetectorOptionLock) != 0;
+  std::string reply;
+  tracker::ReportCapture capture(&reply);
+  if (command == "stats") {
+    if (memory) {
+      MemoryCounters counters = MemoryDetect::GetInstance().GetCounters();
+      TRACKER_PRINT("memory.total_allocated %zu\n", counters.total_allocated);
+      TRACKER_PRINT("memory.total_freed %zu\n", counters.total_freed);
+      TRACKER_PRINT("memory.active_allocations %zu\n",
+                    counters.active_allocations);
+      TRACKER_PRINT("memory.active_bytes %zu\n", counters.active_bytes);
+    }
+    if (lock) {
+      LockCounters counters = LockDetect::GetInstance().GetCounters();
+      TRACKER_PRINT("lock.acquisitions %zu\n", counters.acquisitions);
+      TRACKER_PRINT("lock.contended_acquisitions %zu\n",
+                    counters.contended_acquisitions);
+      TRACKER_PRINT("lock.deadlocks_detected %zu\n",
+                    counters.deadlocks_detected);
+      TRACKER_PRINT("lock.total_wait_ns %lu\n", counters.total_wait_ns);
+    }
+    tracker::OverheadCounters overhead =
+        tracker::OverheadAccounting::Instance().GetCounters(option);
+    TRACKER_PRINT("overhead.hooked_calls %lu\n", overhead.hooked_calls);
+    TRACKER_PRINT("overhead.ns %lu\n", overhead.overhead_ns);
+    TRACKER_PRINT("overhead.metadata_bytes %zu\n", overhead.metadata_bytes);
+    TRACKER_PRINT("overhead.wall_percent %.4f\n", overhead.wall_percent);
+    TRACKER_PRINT("overhead.cpu_percent %.4f\n", overhead.cpu_percent);
+    if (memory) {
+      TRACKER_PRINT("sampling.memory_period %u\n",
+                    MemoryDetect::GetInstance().GetSamplePeriod());
+    }
+    if (lock) {
+      TRACKER_PRINT("sampling.lock_stack_period %u\n",
+                    LockDetect::GetInstance().GetStackSamplePeriod());
+    }
+  } else if (command == "leaks" && memory) {
+    size_t count = kDefaultTopCount;
+    stream >> count;
+    MemoryDetect::GetInstance().PrintTopSites(count);
+  } else if (command == "locks" && lock) {
+    size_t count = kDefaultTopCount;
+    stream >> count;
+    LockDetect::GetInstance().PrintContention(count);
+  } else if (command == "io" && (option & kDetectorOptionIo) != 0) {
+    size_t count = kDefaultTopCount;
+    stream >> count;
+    IoDetect::GetInstance().PrintSlowestSites(count);
+  } else if (command == "threads" && (option & kDetectorOptionThread) != 0) {
+    size_t count = kDefaultTopCount;
+    stream >> count;
+    ThreadDetect::GetInstance().PrintCreationSites(count);
+  } else if (command == "offcpu" &&
+             (option & kDetectorOptionBlocking) != 0) {
+    size_t count = kDefaultTopCount;
+    stream >> count;
+    BlockingDetect::GetInstance().PrintTopSites(count);
+  } else if (command == "fds" && (option & kDetectorOptionFd) != 0) {
+    size_t count = kDefaultTopCount;
+    stream >> count;
+    FdDetect::GetInstance().PrintOpenSites(count);
+  } else if (command == "copies" && (option & kDetectorOptionCopy) != 0) {
+    size_t count = kDefaultTopCount;
+    stream >> count;
+    CopyDetect::GetInstance().PrintTopSites(count);
+  } else if (command == "exceptions" &&
+             (option & kDetectorOptionException) != 0) {
+    size_t count = kDefaultTopCount;
+    stream >> count;
+    ExceptionDetect::GetInstance().PrintTopSites(count);
+  } else if (command == "trace") {
+    if (argument.empty()) {
+      FunctionTrace::GetInstance().Detect();
+    } else {
+      TRACKER_PRINT("traced in %zu modules\n",
+                    FunctionTrace::GetInstance().TraceFunction(argument));
+    }
+  } else if (command == "census") {
+    if (argument == "start") {
+      TRACKER_PRINT("counting %zu imports\n",
+                    FunctionTrace::GetInstance().StartCensus());
+    } else {
+      size_t count = kDefaultTopCount;
+      if (!argument.empty()) {
+        count = strtoul(argument.c_str(), nullptr, 10);
+      }
+      FunctionTrace::GetInstance().PrintCensus(count);
+    }
+  } else if (command == "checkpoint") {
+    if (memory) {
+      MemoryDetect::GetInstance().Checkpoint();
+    }
+    if (lock) {
+      LockDetect::GetInstance().Checkpoint();
+    }
+    TRACKER_PRINT("ok\n");
+  } else if (command == "diff") {
+    if (memory) {
+      MemoryDetect::GetInstance().PrintDiff();
+    }
+    if (lock) {
+      LockDetect::GetInstance().PrintDiff();
+    }
+  } else if (command == "start") {
+    unsigned int interval_ms = kDefaultIntervalMs;
+    if (!argument.empty()) {
+      interval_ms = static_cast<unsigned int>(strtoul(argument.c_str(),
+                                                      nullptr, 10));
+    }
+    periodic_option_.store(option);
+    interval_ms_.store(interval_ms);
+    TRACKER_PRINT("ok\n");
+  } else if (command == "stop") {
+    interval_ms_.store(0);
+    TRACKER_PRINT("ok\n");
+  } else {
+    TRACKER_PRINT(
+        "commands: stats | leaks top [n] | locks contention [n] | "
+        "io slowest [n] | threads sites [n] | offcpu top [n] | "
+        "fds open [n] | copies top [n] | exceptions top [n] | "
+        "trace [symbol] | census start | census [n] | "
+        "checkpoint | diff | start [interval_ms] | stop\n");
+  }
+  return reply;
+}
+DetectorService::DetectorService()
+    : impl_(std::make_unique<DetectorServiceImpl>()) {}
+DetectorService::~DetectorService() = default;
+auto DetectorService::StartPeriodic(unsigned int interval_ms,
+                                    int detect_option) -> void {
+  impl_->StartPeriodic(interval_ms, detect_option);
+}
+auto DetectorService::EnableSignalDump(int signal_number, int detect_option)
+    -> void {
+  impl_->EnableSignalDump(signal_number, detect_option);
+}
+auto DetectorService::EnableControlSocket(const std::string& path,
+                                          int detect_option) -> void {
+  impl_->EnableControlSocket(path, detect_option);
+}
+auto DetectorService::StartPrometheusExport(const std::string& path,
+                                            unsigned int interval_ms,
+                                            int detect_option) -> void {
+  impl_->StartPrometheusExport(path, interval_ms, detect_option);
+}
+auto DetectorService::StartStatsSegment(unsigned int interval_ms,
+                                        int detect_option) -> void {
+  impl_->StartStatsSegment(interval_ms, detect_option);
+}
+auto DetectorService::StartGovernor(double budget_percent,
+                                    int detect_option) -> void {
+  impl_->StartGovernor(budget_percent, detect_option);
+}
+auto DetectorService::Stop() -> void { impl_->Stop(); }
@@ -0,0 +1,410 @@
+#include "exception_detect.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <unwind.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "output_control.h"
+#include "overhead.h"
+#include "plthook.h"
+namespace tracker {
+struct ThrowKey {
+  void* site;
+  const std::type_info* type;
+  auto operator==(const ThrowKey& other) const -> bool = default;
+};
+struct ThrowKeyHash {
+  auto operator()(const ThrowKey& key) const -> size_t {
+    return std::hash<void*>()(key.site) ^
+           (std::hash<const void*>()(key.type) << 1);
+  }
+};
+struct ThrowStats {
+  size_t throws = 0;
+  size_t caught = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  LatencyHistogram latency{};
+  // Throws since window_start_ns, and the most in any window that has
+  // already run for a full second.
+  uint64_t window_start_ns = 0;
+  size_t window_throws = 0;
+  size_t peak_window_throws = 0;
+};
+constexpr uint64_t kRateWindowNs = 1000000000;
+static auto NowNs() -> uint64_t {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+static auto Demangle(const std::type_info* type) -> std::string {
+  if (type == nullptr) {
+    return "?";
+  }
+  int status = 0;
+  char* name = abi::__cxa_demangle(type->name(), nullptr, nullptr, &status);
+  if (name == nullptr) {
+    return type->name();
+  }
+  std::string result(name);
+  free(name);
+  return result;
+}
+class ExceptionTracker {
+ public:
+  static auto GetInstance() -> ExceptionTracker& {
+    static ExceptionTracker instance;
+    return instance;
+  }
+  ExceptionTracker(const ExceptionTracker&) = delete;
+  auto operator=(const ExceptionTracker&) -> ExceptionTracker& = delete;
+  auto Init() -> void { start_ns_ = NowNs(); }
+  auto RecordAllocate(size_t size) -> void {
+    allocated_.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes_.fetch_add(size, std::memory_order_relaxed);
+  }
+  auto RecordThrow(void* site, const std::type_info* type, uint64_t now_ns)
+      -> void;
+  auto RecordCatch(void* site, const std::type_info* type, uint64_t latency_ns)
+      -> void;
+  auto GetCounters() const -> ExceptionCounters {
+    return {allocated_.load(std::memory_order_relaxed),
+            allocated_bytes_.load(std::memory_order_relaxed),
+            throws_.load(std::memory_order_relaxed),
+            caught_.load(std::memory_order_relaxed),
+            throw_to_catch_ns_.load(std::memory_order_relaxed)};
+  }
+  auto GetTopSites(size_t count) const -> std::vector<ExceptionSiteStats>;
+  auto PrintStatus(size_t count) const -> void;
+
+ private:
+  ExceptionTracker() = default;
+  auto ElapsedSeconds() const -> double {
+    constexpr double kNsPerSecond = 1e9;
+    return static_cast<double>(NowNs() - start_ns_) / kNsPerSecond;
+  }
+  uint64_t start_ns_ = 0;
+  mutable std::mutex mutex_;
+  std::unordered_map<ThrowKey, ThrowStats, ThrowKeyHash> sites_;
+  std::atomic<size_t> allocated_ = 0;
+  std::atomic<size_t> allocated_bytes_ = 0;
+  std::atomic<size_t> throws_ = 0;
+  std::atomic<size_t> caught_ = 0;
+  std::atomic<uint64_t> throw_to_catch_ns_ = 0;
+};
+static auto Instance() -> ExceptionTracker& {
+  return ExceptionTracker::GetInstance();
+}
+auto ExceptionTracker::RecordThrow(void* site, const std::type_info* type,
+                                   uint64_t now_ns) -> void {
+  throws_.fetch_add(1, std::memory_order_relaxed);
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& stats = sites_[{site, type}];
+  stats.throws++;
+  if (now_ns - stats.window_start_ns >= kRateWindowNs) {
+    if (stats.window_start_ns != 0) {
+      stats.peak_window_throws =
+          std::max(stats.peak_window_throws, stats.window_throws);
+    }
+    stats.window_start_ns = now_ns;
+    stats.window_throws = 0;
+  }
+  stats.window_throws++;
+}
+auto ExceptionTracker::RecordCatch(void* site, const std::type_info* type,
+                                   uint64_t latency_ns) -> void {
+  caught_.fetch_add(1, std::memory_order_relaxed);
+  throw_to_catch_ns_.fetch_add(latency_ns, std::memory_order_relaxed);
+  size_t bucket = LatencyBucket(latency_ns);
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& stats = sites_[{site, type}];
+  stats.caught++;
+  stats.total_ns += latency_ns;
+  stats.max_ns = std::max(stats.max_ns, latency_ns);
+  stats.latency[bucket]++;
+}
+auto ExceptionTracker::GetTopSites(size_t count) const
+    -> std::vector<ExceptionSiteStats> {
+  std::vector<std::pair<ThrowKey, ThrowStats>> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot.assign(sites_.begin(), sites_.end());
+  }
+  std::ranges::sort(snapshot, [](const auto& lhs, const auto& rhs) {
+    return lhs.second.throws > rhs.second.throws;
+  });
+  if (snapshot.size() > count) {
+    snapshot.resize(count);
+  }
+  double elapsed_s = ElapsedSeconds();
+  uint64_t now_ns = NowNs();
+  std::vector<ExceptionSiteStats> result;
+  result.reserve(snapshot.size());
+  for (const auto& [key, stats] : snapshot) {
+    ExceptionSiteStats site;
+    site.site = key.site;
+    site.type = Demangle(key.type);
+    site.throws = stats.throws;
+    site.caught = stats.caught;
+    site.throws_per_second =
+        elapsed_s > 0.0 ? static_cast<double>(stats.throws) / elapsed_s : 0.0;
+    site.peak_throws_per_second = stats.peak_window_throws;
+    if (now_ns - stats.window_start_ns >= kRateWindowNs) {
+      site.peak_throws_per_second =
+          std::max(site.peak_throws_per_second, stats.window_throws);
+    }
+    site.total_ns = stats.total_ns;
+    site.max_ns = stats.max_ns;
+    site.latency = stats.latency;
+    result.push_back(std::move(site));
+  }
+  return result;
+}
+auto ExceptionTracker::PrintStatus(size_t count) const -> void {
+  constexpr double kNsPerUs = 1000.0;
+  constexpr double kP99 = 0.99;
+  // Beyond this rate an exception is doing the job of a return value.
+  constexpr size_t kHotThrowsPerSecond = 1000;
+  ExceptionCounters counters = GetCounters();
+  std::vector<ExceptionSiteStats> sites = GetTopSites(count);
+  double elapsed_s = ElapsedSeconds();
+  ReportSection section;
+  TRACKER_PRINT("\n\n=== Exception Profile ===\n");
+  TRACKER_PRINT(
+      "Throws: %zu (%.1f/s), caught: %zu, avg throw-to-catch: %.1f us, "
+      "exception objects: %zu (%zu bytes)\n",
+      counters.throws,
+      elapsed_s > 0.0 ? static_cast<double>(counters.throws) / elapsed_s : 0.0,
+      counters.caught,
+      counters.caught == 0 ? 0.0
+                           : static_cast<double>(counters.throw_to_catch_ns) /
+                                 static_cast<double>(counters.caught) /
+                                 kNsPerUs,
+      counters.allocated, counters.allocated_bytes);
+  if (!sites.empty()) {
+    TRACKER_PRINT("\nThrow sites by count:\n");
+  }
+  for (size_t i = 0; i < sites.size(); ++i) {
+    const auto& site = sites[i];
+    // __cxa_throw does not return, so the return address can already be
+    // past the end of the throwing function; look up the call instead.
+    Dl_info dlinfo;
+    const char* symbol = "??";
+    const char* module = "??";
+    if (site.site != nullptr &&
+        dladdr(static_cast<char*>(site.site) - 1, &dlinfo) != 0) {
+      symbol = dlinfo.dli_sname != nullptr ? dlinfo.dli_sname : symbol;
+      module = dlinfo.dli_fname != nullptr ? dlinfo.dli_fname : module;
+    }
+    uint64_t p99 = LatencyPercentile(site.latency, kP99, site.max_ns);
+    TRACKER_PRINT("[%zu] %s thrown at %p %s (%s)\n", i, site.type.c_str(),
+                  site.site, symbol, module);
+    TRACKER_PRINT(
+        "    throws: %zu (%.1f/s), caught: %zu, throw-to-catch avg: %.1f us, "
+        "p99: %.1f us, max: %.1f us\n",
+        site.throws, site.throws_per_second, site.caught,
+        site.caught == 0 ? 0.0
+                         : static_cast<double>(site.total_ns) /
+                               static_cast<double>(site.caught) / kNsPerUs,
+        static_cast<double>(p99) / kNsPerUs,
+        static_cast<double>(site.max_ns) / kNsPerUs);
+    if (site.peak_throws_per_second >= kHotThrowsPerSecond) {
+      TRACKER_WARNING(
+          "%zu throws within one second at this site; exceptions on a hot "
+          "path\n",
+          site.peak_throws_per_second);
+    }
+  }
+  TRACKER_PRINT("===========================\n");
+}
+}  // namespace tracker
+// Throws the current thread has not caught yet. A catch in a module without
+// hooks never claims its entry; the ring overwrites the oldest, and is
+// emptied whenever the thread has no exception in flight.
+struct InFlightThrow {
+  void* object;
+  void* site;
+  const std::type_info* type;
+  uint64_t throw_ns;
+};
+constexpr size_t kMaxInFlightThrows = 8;
+static thread_local std::array<InFlightThrow, kMaxInFlightThrows> in_flight{};
+static thread_local size_t in_flight_next = 0;
+// Once nothing is in flight every remaining entry was caught unseen, and its
+// object address may be handed out again.
+static auto ClearStaleInFlight() -> void {
+  if (std::uncaught_exceptions() == 0) {
+    in_flight.fill({});
+  }
+}
+static auto ForgetInFlight(void* object) -> void {
+  for (auto& entry : in_flight) {
+    if (entry.object == object) {
+      entry.object = nullptr;
+    }
+  }
+}
+static auto HookedCxaAllocateException(size_t size) -> void* {
+  void* object = __cxxabiv1::__cxa_allocate_exception(size);
+  tracker::HookScope scope(tracker::HookKind::kCxaAllocateException);
+  tracker::Instance().RecordAllocate(size);
+  return object;
+}
+[[noreturn]] static auto HookedCxaThrow(void* object, std::type_info* type,
+                                        void (*destructor)(void*)) -> void {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  {
+    tracker::HookScope scope(tracker::HookKind::kCxaThrow);
+    tracker::Instance().RecordThrow(site, type, tracker::NowNs());
+  }
+  ClearStaleInFlight();
+  ForgetInFlight(object);
+  in_flight[in_flight_next] = {object, site, type, tracker::NowNs()};
+  in_flight_next = (in_flight_next + 1) % kMaxInFlightThrows;
+  __cxxabiv1::__cxa_throw(object, type, destructor);
+}
+static auto HookedCxaBeginCatch(void* header) -> void* {
+  uint64_t catch_ns = tracker::NowNs();
+  void* result = __cxxabiv1::__cxa_begin_catch(header);
+  // The thrown object follows the unwinder's header; catching by base
+  // class may adjust the returned pointer, so do not match on that.
+  void* object = static_cast<char*>(header) + sizeof(_Unwind_Exception);
+  for (auto& entry : in_flight) {
+    if (entry.object == object) {
+      tracker::HookScope scope(tracker::HookKind::kCxaBeginCatch);
+      tracker::Instance().RecordCatch(entry.site, entry.type,
+                                      catch_ns - entry.throw_ns);
+      entry.object = nullptr;
+      break;
+    }
+  }
+  return result;
+}
+static auto HookedCxaEndCatch() -> void {
+  __cxxabiv1::__cxa_end_catch();
+  ClearStaleInFlight();
+}
+static auto HookedCxaFreeException(void* object) -> void {
+  ForgetInFlight(object);
+  __cxxabiv1::__cxa_free_exception(object);
+}
+class ExceptionHook {
+ public:
+  explicit ExceptionHook(std::string lib_path)
+      : lib_path_(std::move(lib_path)) {}
+  ~ExceptionHook() = default;
+  auto Start() -> void;
+
+ private:
+  std::string lib_path_;
+  std::unique_ptr<PltHook> hook_;
+};
+auto ExceptionHook::Start() -> void {
+  hook_ = PltHook::Create(lib_path_.c_str());
+  try {
+    std::vector<std::string> hooked_functions;
+    auto try_hook = [&](const char* symbol, void* hook_func) {
+      if (hook_->ReplaceFunction(symbol, hook_func, nullptr) ==
+          PltHook::ErrorCode::kSuccess) {
+        hooked_functions.emplace_back(symbol);
+      }
+    };
+    try_hook("__cxa_allocate_exception",
+             reinterpret_cast<void*>(&HookedCxaAllocateException));
+    try_hook("__cxa_throw", reinterpret_cast<void*>(&HookedCxaThrow));
+    try_hook("__cxa_begin_catch",
+             reinterpret_cast<void*>(&HookedCxaBeginCatch));
+    try_hook("__cxa_end_catch", reinterpret_cast<void*>(&HookedCxaEndCatch));
+    try_hook("__cxa_free_exception",
+             reinterpret_cast<void*>(&HookedCxaFreeException));
+    tracker::ReportSection section;
+    auto& output = tracker::OutputControl::Instance();
+    output.PrintColored(tracker::Color::kGreen, tracker::Color::kReset,
+                        "Hooked exception functions: ");
+    for (size_t i = 0; i < hooked_functions.size(); ++i) {
+      TRACKER_PRINT("%s", hooked_functions[i].c_str());
+      if (i < hooked_functions.size() - 1) {
+        TRACKER_PRINT(", ");
+      }
+    }
+    TRACKER_PRINT("\n");
+  } catch (const std::exception& e) {
+    TRACKER_ERROR("Error starting exception tracking: %s", e.what());
+  }
+}
+class ExceptionDetectImpl {
+ public:
+  ExceptionDetectImpl() = default;
+  ~ExceptionDetectImpl() = default;
+  auto Register(const std::string& lib_name) -> void;
+  auto RegisterMain() -> void;
+  auto Start() -> void;
+  auto Detect() -> void;
+  auto GetCounters() const -> ExceptionCounters;
+  auto GetTopSites(size_t count) const -> std::vector<ExceptionSiteStats>;
+  auto PrintTopSites(size_t count) -> void;
+
+ private:
+  std::vector<std::unique_ptr<ExceptionHook>> hooks_;
+};
+auto ExceptionDetectImpl::Register(const std::string& lib_name) -> void {
+  hooks_.emplace_back(std::make_unique<ExceptionHook>(lib_name));
+}
+auto ExceptionDetectImpl::RegisterMain() -> void {
+  hooks_.emplace_back(std::make_unique<ExceptionHook>(std::string()));
+}
+auto ExceptionDetectImpl::Start() -> void {
+  tracker::Instance().Init();
+  tracker::OverheadAccounting::Instance().Start();
+  for (auto& hook : hooks_) {
+    hook->Start();
+  }
+}
+auto ExceptionDetectImpl::Detect() -> void {
+  constexpr size_t kReportCount = 10;
+  tracker::Instance().PrintStatus(kReportCount);
+}
+auto ExceptionDetectImpl::GetCounters() const -> ExceptionCounters {
+  return tracker::Instance().GetCounters();
+}
+auto ExceptionDetectImpl::GetTopSites(size_t count) const
+    -> std::vector<ExceptionSiteStats> {
+  return tracker::Instance().GetTopSites(count);
+}
+auto ExceptionDetectImpl::PrintTopSites(size_t count) -> void {
+  tracker::Instance().PrintStatus(count);
+}
+ExceptionDetect::ExceptionDetect()
+    : impl_(std::make_unique<ExceptionDetectImpl>()) {}
+ExceptionDetect::~ExceptionDetect() = default;
+auto ExceptionDetect::Register(const std::string& lib_name) -> void {
+  impl_->Register(lib_name);
+}
+auto ExceptionDetect::RegisterMain() -> void { impl_->RegisterMain(); }
+auto ExceptionDetect::Start() -> void { impl_->Start(); }
+auto ExceptionDetect::Detect() -> void { impl_->Detect(); }
+auto ExceptionDetect::GetCounters() const -> ExceptionCounters {
+  return impl_->GetCounters();
+}
+auto ExceptionDetect::GetTopSites(size_t count) const
+    -> std::vector<ExceptionSiteStats> {
+  return impl_->GetTopSites(count);
+}
+auto ExceptionDetect::PrintTopSites(size_t count) -> void {
+  impl_->PrintTopSites(count);
+}
@@ -0,0 +1,604 @@
+#include "fd_detect.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unordered_map>
+#include <vector>
+
+#include "output_control.h"
+#include "overhead.h"
+#include "plthook.h"
+auto FdKindName(FdKind kind) -> const char* {
+  switch (kind) {
+    case FdKind::kNone:
+      return "none";
+    case FdKind::kFile:
+      return "file";
+    case FdKind::kSocket:
+      return "socket";
+    case FdKind::kPipe:
+      return "pipe";
+    case FdKind::kDup:
+      return "dup";
+    case FdKind::kEventfd:
+      return "eventfd";
+    case FdKind::kEpoll:
+      return "epoll";
+  }
+  return "?";
+}
+namespace tracker {
+// Plain fields accessed through atomic_ref: the table is fresh anonymous
+// memory, and all-zero is a valid empty slot without touching every page.
+struct FdSlot {
+  uintptr_t site;
+  uint32_t kind;
+  uint32_t opened_s;  // seconds since Start
+};
+class FdTracker {
+ public:
+  static auto GetInstance() -> FdTracker& {
+    static FdTracker instance;
+    return instance;
+  }
+  FdTracker(const FdTracker&) = delete;
+  auto operator=(const FdTracker&) -> FdTracker& = delete;
+  auto Init() -> void;
+  auto RecordOpen(int fd, FdKind kind, void* site) -> void;
+  auto RecordClose(int fd) -> void;
+  auto GetCounters() const -> FdCounters {
+    size_t opened = opened_.load(std::memory_order_relaxed);
+    size_t closed = closed_.load(std::memory_order_relaxed);
+    return {opened,
+            closed,
+            opened > closed ? opened - closed : 0,
+            peak_open_.load(std::memory_order_relaxed),
+            untracked_closes_.load(std::memory_order_relaxed),
+            overflow_.load(std::memory_order_relaxed),
+            size_};
+  }
+  auto GetOpenSites(size_t count) -> std::vector<FdSiteStats>;
+  auto PrintStatus(size_t count) -> void;
+
+ private:
+  FdTracker() = default;
+  // Ages are reported in whole seconds, so the coarse clock is enough and
+  // keeps the open path off the full clock read.
+  auto NowSeconds() const -> uint32_t {
+    struct timespec now {};
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return static_cast<uint32_t>(now.tv_sec - start_s_);
+  }
+  FdSlot* slots_ = nullptr;
+  size_t size_ = 0;
+  std::chrono::steady_clock::time_point start_;
+  time_t start_s_ = 0;
+  std::atomic<int> high_water_ = -1;
+  // Bumped from every thread on every open and close; kept on separate
+  // cache lines.
+  alignas(64) std::atomic<size_t> opened_ = 0;
+  alignas(64) std::atomic<size_t> closed_ = 0;
+  alignas(64) std::atomic<size_t> peak_open_ = 0;
+  std::atomic<size_t> untracked_closes_ = 0;
+  std::atomic<size_t> overflow_ = 0;
+};
+static auto Instance() -> FdTracker& { return FdTracker::GetInstance(); }
+auto FdTracker::Init() -> void {
+  // Beyond this the table would cost more address space than it is worth;
+  // higher descriptors are only counted.
+  constexpr size_t kMaxTableSize = size_t{1} << 20;
+  if (slots_ != nullptr) {
+    return;
+  }
+  start_ = std::chrono::steady_clock::now();
+  struct timespec now {};
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  start_s_ = now.tv_sec;
+  struct rlimit limit {};
+  size_t size = kMaxTableSize;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 &&
+      limit.rlim_cur != RLIM_INFINITY) {
+    size = std::min<size_t>(limit.rlim_cur, kMaxTableSize);
+  }
+  void* table = mmap(nullptr, size * sizeof(FdSlot), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (table == MAP_FAILED) {
+    TRACKER_ERROR("Failed to map descriptor table: %s\n", strerror(errno));
+    return;
+  }
+  slots_ = static_cast<FdSlot*>(table);
+  size_ = size;
+}
+auto FdTracker::RecordOpen(int fd, FdKind kind, void* site) -> void {
+  if (fd < 0) {
+    return;
+  }
+  size_t opened = opened_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (static_cast<size_t>(fd) >= size_) {
+    overflow_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  FdSlot& slot = slots_[fd];
+  std::atomic_ref<uint32_t>(slot.kind).store(static_cast<uint32_t>(kind),
+                                             std::memory_order_relaxed);
+  std::atomic_ref<uint32_t>(slot.opened_s)
+      .store(NowSeconds(), std::memory_order_relaxed);
+  // A live entry here was closed behind our back (dup2 onto it, or a close
+  // we do not see).
+  if (std::atomic_ref<uintptr_t>(slot.site).exchange(
+          reinterpret_cast<uintptr_t>(site), std::memory_order_release) != 0) {
+    closed_.fetch_add(1, std::memory_order_relaxed);
+  }
+  int high = high_water_.load(std::memory_order_relaxed);
+  while (fd > high && !high_water_.compare_exchange_weak(
+                          high, fd, std::memory_order_relaxed)) {
+  }
+  size_t closed = closed_.load(std::memory_order_relaxed);
+  size_t open = opened > closed ? opened - closed : 0;
+  size_t peak = peak_open_.load(std::memory_order_relaxed);
+  while (open > peak && !peak_open_.compare_exchange_weak(
+                            peak, open, std::memory_order_relaxed)) {
+  }
+}
+auto FdTracker::RecordClose(int fd) -> void {
+  if (fd < 0 || static_cast<size_t>(fd) >= size_) {
+    untracked_closes_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (std::atomic_ref<uintptr_t>(slots_[fd].site)
+          .exchange(0, std::memory_order_acq_rel) != 0) {
+    closed_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    untracked_closes_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+auto FdTracker::GetOpenSites(size_t count) -> std::vector<FdSiteStats> {
+  constexpr size_t kSampleFds = 8;
+  std::unordered_map<uintptr_t, FdSiteStats> sites;
+  uint32_t now_s = NowSeconds();
+  int high = high_water_.load(std::memory_order_relaxed);
+  for (int fd = 0; fd <= high; ++fd) {
+    FdSlot& slot = slots_[fd];
+    uintptr_t site =
+        std::atomic_ref<uintptr_t>(slot.site).load(std::memory_order_acquire);
+    if (site == 0) {
+      continue;
+    }
+    if (fcntl(fd, F_GETFD) == -1 && errno == EBADF) {
+      // Closed where no hook could see it.
+      if (std::atomic_ref<uintptr_t>(slot.site)
+              .compare_exchange_strong(site, 0, std::memory_order_acq_rel)) {
+        closed_.fetch_add(1, std::memory_order_relaxed);
+      }
+      continue;
+    }
+    auto& stats = sites[site];
+    stats.site = reinterpret_cast<void*>(site);
+    stats.kind = static_cast<FdKind>(
+        std::atomic_ref<uint32_t>(slot.kind).load(std::memory_order_relaxed));
+    stats.open++;
+    uint32_t opened_s = std::atomic_ref<uint32_t>(slot.opened_s)
+                            .load(std::memory_order_relaxed);
+    stats.oldest_age_s = std::max(stats.oldest_age_s, now_s - opened_s);
+    if (stats.sample_fds.size() < kSampleFds) {
+      stats.sample_fds.push_back(fd);
+    }
+  }
+  std::vector<FdSiteStats> result;
+  result.reserve(sites.size());
+  for (auto& pair : sites) {
+    result.push_back(std::move(pair.second));
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.open > rhs.open;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto FdTracker::PrintStatus(size_t count) -> void {
+  constexpr double kPercent = 100.0;
+  if (slots_ == nullptr) {
+    return;
+  }
+  // Sites first: the walk also settles descriptors closed out of sight.
+  std::vector<FdSiteStats> sites = GetOpenSites(count);
+  FdCounters counters = GetCounters();
+  double elapsed_s = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start_)
+                         .count();
+  auto rate = [elapsed_s](size_t value) {
+    return elapsed_s > 0.0 ? static_cast<double>(value) / elapsed_s : 0.0;
+  };
+  ReportSection section;
+  TRACKER_PRINT("\n\n=== Descriptor Table ===\n");
+  TRACKER_PRINT(
+      "Open: %zu of %zu (%.1f%%), peak: %zu, opened: %zu (%.1f/s), closed: "
+      "%zu (%.1f/s), untracked closes: %zu\n",
+      counters.open, counters.limit,
+      counters.limit == 0 ? 0.0
+                          : kPercent * static_cast<double>(counters.open) /
+                                static_cast<double>(counters.limit),
+      counters.peak_open, counters.opened, rate(counters.opened),
+      counters.closed, rate(counters.closed), counters.untracked_closes);
+  if (counters.overflow != 0) {
+    TRACKER_WARNING("%zu descriptors above the table size were not tracked\n",
+                    counters.overflow);
+  }
+  if (!sites.empty()) {
+    TRACKER_PRINT("\nOpen descriptors by site:\n");
+  }
+  for (size_t i = 0; i < sites.size(); ++i) {
+    const auto& site = sites[i];
+    Dl_info dlinfo;
+    const char* symbol = "??";
+    const char* module = "??";
+    if (site.site != nullptr && dladdr(site.site, &dlinfo) != 0) {
+      symbol = dlinfo.dli_sname != nullptr ? dlinfo.dli_sname : symbol;
+      module = dlinfo.dli_fname != nullptr ? dlinfo.dli_fname : module;
+    }
+    TRACKER_PRINT("[%zu] %s at %p %s (%s)\n", i, FdKindName(site.kind),
+                  site.site, symbol, module);
+    TRACKER_PRINT("    open: %zu, oldest: %u s, fds:", site.open,
+                  site.oldest_age_s);
+    for (int fd : site.sample_fds) {
+      TRACKER_PRINT(" %d", fd);
+    }
+    TRACKER_PRINT(site.open > site.sample_fds.size() ? " ...\n" : "\n");
+  }
+  TRACKER_PRINT("===========================\n");
+}
+}  // namespace tracker
+static auto RecordOpen(int fd, FdKind kind, void* site) -> int {
+  if (fd >= 0) {
+    tracker::HookScope scope(tracker::HookKind::kFdOpen);
+    tracker::Instance().RecordOpen(fd, kind, site);
+  }
+  return fd;
+}
+// Mode is only passed when the flags ask for it.
+static auto OpenMode(int flags, va_list args) -> mode_t {
+  if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE) {
+    return static_cast<mode_t>(va_arg(args, unsigned int));
+  }
+  return 0;
+}
+static auto HookedOpen(const char* path, int flags, ...) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  va_list args;
+  va_start(args, flags);
+  mode_t mode = OpenMode(flags, args);
+  va_end(args);
+  return RecordOpen(open(path, flags, mode), FdKind::kFile, site);
+}
+static auto HookedOpenat(int dirfd, const char* path, int flags, ...) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  va_list args;
+  va_start(args, flags);
+  mode_t mode = OpenMode(flags, args);
+  va_end(args);
+  return RecordOpen(openat(dirfd, path, flags, mode), FdKind::kFile, site);
+}
+static auto HookedCreat(const char* path, mode_t mode) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  return RecordOpen(creat(path, mode), FdKind::kFile, site);
+}
+static auto HookedSocket(int domain, int type, int protocol) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  return RecordOpen(socket(domain, type, protocol), FdKind::kSocket, site);
+}
+static auto HookedSocketpair(int domain, int type, int protocol, int fds[2])
+    -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  int result = socketpair(domain, type, protocol, fds);
+  if (result == 0) {
+    RecordOpen(fds[0], FdKind::kSocket, site);
+    RecordOpen(fds[1], FdKind::kSocket, site);
+  }
+  return result;
+}
+// accept and accept4 may already be taken over in a module's slot, by the
+// blocking-call profiler, a trace trampoline or a call census stub. Every
+// module forwards to whatever its own slot held before FdHook replaced it,
+// found by the module the call site lies in.
+using AcceptFn = int (*)(int, struct sockaddr*, socklen_t*);
+using Accept4Fn = int (*)(int, struct sockaddr*, socklen_t*, int);
+struct AcceptChain {
+  const void* module_base;
+  AcceptFn accept;
+  Accept4Fn accept4;
+};
+constexpr size_t kMaxAcceptChains = 256;
+static std::array<AcceptChain, kMaxAcceptChains> accept_chains;
+static std::atomic<size_t> accept_chain_count = 0;
+static constexpr AcceptChain kLibcAccept = {nullptr, &accept, &accept4};
+static auto ChainFor(void* site) -> const AcceptChain& {
+  Dl_info info;
+  if (site == nullptr || dladdr(site, &info) == 0) {
+    return kLibcAccept;
+  }
+  size_t count = accept_chain_count.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i) {
+    if (accept_chains[i].module_base == info.dli_fbase) {
+      return accept_chains[i];
+    }
+  }
+  return kLibcAccept;
+}
+static auto HookedAccept(int fd, struct sockaddr* addr, socklen_t* addrlen)
+    -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  int result = 0;
+  {
+    tracker::ForwardedCall forward(site);
+    result = ChainFor(site).accept(fd, addr, addrlen);
+  }
+  return RecordOpen(result, FdKind::kSocket, site);
+}
+static auto HookedAccept4(int fd, struct sockaddr* addr, socklen_t* addrlen,
+                          int flags) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  int result = 0;
+  {
+    tracker::ForwardedCall forward(site);
+    result = ChainFor(site).accept4(fd, addr, addrlen, flags);
+  }
+  return RecordOpen(result, FdKind::kSocket, site);
+}
+static auto HookedPipe(int fds[2]) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  int result = pipe(fds);
+  if (result == 0) {
+    RecordOpen(fds[0], FdKind::kPipe, site);
+    RecordOpen(fds[1], FdKind::kPipe, site);
+  }
+  return result;
+}
+static auto HookedPipe2(int fds[2], int flags) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  int result = pipe2(fds, flags);
+  if (result == 0) {
+    RecordOpen(fds[0], FdKind::kPipe, site);
+    RecordOpen(fds[1], FdKind::kPipe, site);
+  }
+  return result;
+}
+static auto HookedDup(int oldfd) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  return RecordOpen(dup(oldfd), FdKind::kDup, site);
+}
+static auto HookedDup2(int oldfd, int newfd) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  // dup2 onto itself is a no-op that must not count as a new descriptor
+  if (oldfd != newfd) {
+    tracker::BumpFdGeneration(newfd);
+  }
+  int result = dup2(oldfd, newfd);
+  return oldfd == newfd ? result : RecordOpen(result, FdKind::kDup, site);
+}
+static auto HookedDup3(int oldfd, int newfd, int flags) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  tracker::BumpFdGeneration(newfd);
+  return RecordOpen(dup3(oldfd, newfd, flags), FdKind::kDup, site);
+}
+static auto HookedEventfd(unsigned int initval, int flags) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  return RecordOpen(eventfd(initval, flags), FdKind::kEventfd, site);
+}
+static auto HookedEpollCreate(int size) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  return RecordOpen(epoll_create(size), FdKind::kEpoll, site);
+}
+static auto HookedEpollCreate1(int flags) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  return RecordOpen(epoll_create1(flags), FdKind::kEpoll, site);
+}
+static auto HookedClose(int fd) -> int {
+  // Forget the slot first: once close returns, another thread may already
+  // have been handed the same number.
+  {
+    tracker::HookScope scope(tracker::HookKind::kFdClose);
+    tracker::Instance().RecordClose(fd);
+  }
+  tracker::BumpFdGeneration(fd);
+  return close(fd);
+}
+// What the module's slot for symbol forwards to when it is taken over by
+// another hook, or nullptr for a slot that is missing, still bound to the
+// libc function, or unresolved (a lazy slot points into the module's own
+// PLT and would rebind over the hook).
+static auto ChainedHook(const PltHook& hook, const char* symbol,
+                        void* own_hook) -> void* {
+  unsigned int pos = 0;
+  const char* name = nullptr;
+  void** addr = nullptr;
+  while (hook.EnumerateSymbols(pos, name, addr) ==
+         PltHook::ErrorCode::kSuccess) {
+    if (strcmp(name, symbol) != 0) {
+      continue;
+    }
+    void* current = *addr;
+    Dl_info module_info;
+    Dl_info target_info;
+    if (current == own_hook || current == dlsym(RTLD_DEFAULT, symbol) ||
+        (dladdr(static_cast<void*>(addr), &module_info) != 0 &&
+         dladdr(current, &target_info) != 0 &&
+         target_info.dli_fbase == module_info.dli_fbase)) {
+      return nullptr;
+    }
+    return current;
+  }
+  return nullptr;
+}
+class FdHook {
+ public:
+  explicit FdHook(std::string lib_path) : lib_path_(std::move(lib_path)) {}
+  ~FdHook() = default;
+  auto Start() -> void;
+
+ private:
+  auto RecordAcceptChain() -> void;
+  std::string lib_path_;
+  std::unique_ptr<PltHook> hook_;
+};
+// Runs before the slots are replaced. A module registered again keeps its
+// first entry: its slots already hold our own hooks.
+auto FdHook::RecordAcceptChain() -> void {
+  unsigned int pos = 0;
+  const char* name = nullptr;
+  void** addr = nullptr;
+  Dl_info module_info;
+  if (hook_->EnumerateSymbols(pos, name, addr) !=
+          PltHook::ErrorCode::kSuccess ||
+      dladdr(static_cast<void*>(addr), &module_info) == 0) {
+    return;
+  }
+  size_t count = accept_chain_count.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; ++i) {
+    if (accept_chains[i].module_base == module_info.dli_fbase) {
+      return;
+    }
+  }
+  if (count == kMaxAcceptChains) {
+    TRACKER_WARNING("Too many modules; accept in %s bypasses earlier hooks\n",
+                    lib_path_.c_str());
+    return;
+  }
+  AcceptChain chain = kLibcAccept;
+  chain.module_base = module_info.dli_fbase;
+  if (void* next = ChainedHook(*hook_, "accept",
+                               reinterpret_cast<void*>(&HookedAccept));
+      next != nullptr) {
+    chain.accept = reinterpret_cast<AcceptFn>(next);
+  }
+  if (void* next = ChainedHook(*hook_, "accept4",
+                               reinterpret_cast<void*>(&HookedAccept4));
+      next != nullptr) {
+    chain.accept4 = reinterpret_cast<Accept4Fn>(next);
+  }
+  accept_chains[count] = chain;
+  accept_chain_count.store(count + 1, std::memory_order_release);
+}
+auto FdHook::Start() -> void {
+  hook_ = PltHook::Create(lib_path_.c_str());
+  try {
+    RecordAcceptChain();
+    std::vector<std::string> hooked_functions;
+    auto try_hook = [&](const char* symbol, void* hook_func) {
+      if (hook_->ReplaceFunction(symbol, hook_func, nullptr) ==
+          PltHook::ErrorCode::kSuccess) {
+        hooked_functions.emplace_back(symbol);
+      }
+    };
+    // Large-file builds import the 64-bit names; on LP64 they are the same
+    // functions.
+    try_hook("open", reinterpret_cast<void*>(&HookedOpen));
+    try_hook("open64", reinterpret_cast<void*>(&HookedOpen));
+    try_hook("openat", reinterpret_cast<void*>(&HookedOpenat));
+    try_hook("openat64", reinterpret_cast<void*>(&HookedOpenat));
+    try_hook("creat", reinterpret_cast<void*>(&HookedCreat));
+    try_hook("creat64", reinterpret_cast<void*>(&HookedCreat));
+    try_hook("socket", reinterpret_cast<void*>(&HookedSocket));
+    try_hook("socketpair", reinterpret_cast<void*>(&HookedSocketpair));
+    try_hook("accept", reinterpret_cast<void*>(&HookedAccept));
+    try_hook("accept4", reinterpret_cast<void*>(&HookedAccept4));
+    try_hook("pipe", reinterpret_cast<void*>(&HookedPipe));
+    try_hook("pipe2", reinterpret_cast<void*>(&HookedPipe2));
+    try_hook("dup", reinterpret_cast<void*>(&HookedDup));
+    try_hook("dup2", reinterpret_cast<void*>(&HookedDup2));
+    try_hook("dup3", reinterpret_cast<void*>(&HookedDup3));
+    try_hook("eventfd", reinterpret_cast<void*>(&HookedEventfd));
+    try_hook("epoll_create", reinterpret_cast<void*>(&HookedEpollCreate));
+    try_hook("epoll_create1", reinterpret_cast<void*>(&HookedEpollCreate1));
+    try_hook("close", reinterpret_cast<void*>(&HookedClose));
+    tracker::ReportSection section;
+    auto& output = tracker::OutputControl::Instance();
+    output.PrintColored(tracker::Color::kGreen, tracker::Color::kReset,
+                        "Hooked descriptor functions: ");
+    for (size_t i = 0; i < hooked_functions.size(); ++i) {
+      TRACKER_PRINT("%s", hooked_functions[i].c_str());
+      if (i < hooked_functions.size() - 1) {
+        TRACKER_PRINT(", ");
+      }
+    }
+    TRACKER_PRINT("\n");
+  } catch (const std::exception& e) {
+    TRACKER_ERROR("Error starting descriptor tracking: %s", e.what());
+  }
+}
+class FdDetectImpl {
+ public:
+  FdDetectImpl() = default;
+  ~FdDetectImpl() = default;
+  auto Register(const std::string& lib_name) -> void;
+  auto RegisterMain() -> void;
+  auto Start() -> void;
+  auto Detect() -> void;
+  auto GetCounters() const -> FdCounters;
+  auto GetOpenSites(size_t count) const -> std::vector<FdSiteStats>;
+  auto PrintOpenSites(size_t count) -> void;
+
+ private:
+  std::vector<std::unique_ptr<FdHook>> hooks_;
+};
+auto FdDetectImpl::Register(const std::string& lib_name) -> void {
+  hooks_.emplace_back(std::make_unique<FdHook>(lib_name));
+}
+auto FdDetectImpl::RegisterMain() -> void {
+  hooks_.emplace_back(std::make_unique<FdHook>(std::string()));
+}
+auto FdDetectImpl::Start() -> void {
+  tracker::Instance().Init();
+  tracker::OverheadAccounting::Instance().Start();
+  for (auto& hook : hooks_) {
+    hook->Start();
+  }
+}
+auto FdDetectImpl::Detect() -> void {
+  constexpr size_t kReportCount = 10;
+  tracker::Instance().PrintStatus(kReportCount);
+}
+auto FdDetectImpl::GetCounters() const -> FdCounters {
+  return tracker::Instance().GetCounters();
+}
+auto FdDetectImpl::GetOpenSites(size_t count) const
+    -> std::vector<FdSiteStats> {
+  return tracker::Instance().GetOpenSites(count);
+}
+auto FdDetectImpl::PrintOpenSites(size_t count) -> void {
+  tracker::Instance().PrintStatus(count);
+}
+FdDetect::FdDetect() : impl_(std::make_unique<FdDetectImpl>()) {}
+FdDetect::~FdDetect() = default;
+auto FdDetect::Register(const std::string& lib_name) -> void {
+  impl_->Register(lib_name);
+}
+auto FdDetect::RegisterMain() -> void { impl_->RegisterMain(); }
+auto FdDetect::Start() -> void { impl_->Start(); }
+auto FdDetect::Detect() -> void { impl_->Detect(); }
+auto FdDetect::GetCounters() const -> FdCounters {
+  return impl_->GetCounters();
+}
+auto FdDetect::GetOpenSites(size_t count) const -> std::vector<FdSiteStats> {
+  return impl_->GetOpenSites(count);
+}
+auto FdDetect::PrintOpenSites(size_t count) -> void {
+  impl_->PrintOpenSites(count);
+}
@@ -0,0 +1,552 @@
+#include "function_trace.h"
+
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "output_control.h"
+#include "overhead.h"
+#include "plthook.h"
+namespace tracker {
+struct TraceSlot {
+  std::string symbol;
+  size_t modules = 0;
+  std::atomic<size_t> calls = 0;
+  std::atomic<uint64_t> total_ns = 0;
+  std::atomic<uint64_t> max_ns = 0;
+  std::array<std::atomic<uint64_t>, kLatencyBuckets> latency{};
+};
+// Own cache line per slot, so threads hammering different imports do not
+// share one.
+struct alignas(64) CensusCounter {
+  std::atomic<uint64_t> calls = 0;
+};
+struct CensusEntry {
+  std::string module;
+  std::string symbol;
+  CensusCounter* counter;
+};
+// One per trampoline: the same symbol can lead to a detector hook in one
+// module and straight to libc in another.
+struct TraceTarget {
+  TraceSlot* slot;
+  // The trampoline calls another detector's hook, which would otherwise see
+  // the trampoline as its call site.
+  bool forwards_to_hook;
+};
+struct ShadowFrame {
+  void* return_address;
+  TraceSlot* slot;
+  std::chrono::steady_clock::time_point start;
+  bool forwarded;
+  void* outer_site;
+};
+// Deep enough for any sane nesting of traced calls; beyond it calls run
+// untraced instead of failing.
+constexpr size_t kShadowStackDepth = 128;
+struct ShadowStack {
+  size_t depth = 0;
+  std::array<ShadowFrame, kShadowStackDepth> frames;
+};
+static thread_local ShadowStack shadow_stack;
+// Called from the trampoline prologue. Returns 0 to make the trampoline
+// tail-jump to the original with the return address left in place.
+static auto TraceEnter(TraceTarget* target, void* return_address)
+    -> uint64_t {
+  if (shadow_stack.depth == kShadowStackDepth) {
+    return 0;
+  }
+  shadow_stack.frames[shadow_stack.depth++] = {
+      return_address, target->slot, std::chrono::steady_clock::now(),
+      target->forwards_to_hook, forwarded_site};
+  if (target->forwards_to_hook) {
+    forwarded_site = return_address;
+  }
+  return 1;
+}
+// Called from the trampoline epilogue; returns where the traced call has to
+// go back to.
+static auto TraceExit() -> void* {
+  auto now = std::chrono::steady_clock::now();
+  const ShadowFrame& frame = shadow_stack.frames[--shadow_stack.depth];
+  if (frame.forwarded) {
+    forwarded_site = frame.outer_site;
+  }
+  auto latency = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame.start)
+          .count());
+  TraceSlot& slot = *frame.slot;
+  slot.calls.fetch_add(1, std::memory_order_relaxed);
+  slot.total_ns.fetch_add(latency, std::memory_order_relaxed);
+  slot.latency[LatencyBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+  uint64_t max_ns = slot.max_ns.load(std::memory_order_relaxed);
+  while (latency > max_ns && !slot.max_ns.compare_exchange_weak(
+                                 max_ns, latency, std::memory_order_relaxed)) {
+  }
+  return frame.return_address;
+}
+#if defined(__x86_64__)
+// Copies generated code into fresh pages and seals them read+execute.
+static auto MapCode(const std::vector<uint8_t>& code) -> void* {
+  auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t length = (code.size() + page_size - 1) / page_size * page_size;
+  void* pages = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED) {
+    return nullptr;
+  }
+  memcpy(pages, code.data(), code.size());
+  if (mprotect(pages, length, PROT_READ | PROT_EXEC) != 0) {
+    munmap(pages, length);
+    return nullptr;
+  }
+  return pages;
+}
+// Minimal x86-64 encoder for the fixed trampoline shape below.
+class TrampolineWriter {
+ public:
+  auto Bytes(std::initializer_list<uint8_t> bytes) -> void {
+    code_.insert(code_.end(), bytes);
+  }
+  auto Imm32(uint32_t value) -> void {
+    for (int i = 0; i < 4; ++i) {
+      code_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+  }
+  auto Imm64(const void* pointer) -> void {
+    auto value = reinterpret_cast<uint64_t>(pointer);
+    for (int i = 0; i < 8; ++i) {
+      code_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+  }
+  // movdqu [rsp + offset], xmmN / movdqu xmmN, [rsp + offset]
+  auto StoreXmm(uint8_t reg, uint32_t offset) -> void {
+    Bytes({0xF3, 0x0F, 0x7F, static_cast<uint8_t>(0x84 | (reg << 3)), 0x24});
+    Imm32(offset);
+  }
+  auto LoadXmm(uint8_t reg, uint32_t offset) -> void {
+    Bytes({0xF3, 0x0F, 0x6F, static_cast<uint8_t>(0x84 | (reg << 3)), 0x24});
+    Imm32(offset);
+  }
+  [[nodiscard]] auto Size() const -> size_t { return code_.size(); }
+  auto PatchRel32(size_t at, size_t target) -> void {
+    auto rel = static_cast<uint32_t>(target - (at + 4));
+    for (size_t i = 0; i < 4; ++i) {
+      code_[at + i] = static_cast<uint8_t>(rel >> (8 * i));
+    }
+  }
+  [[nodiscard]] auto Code() const -> const std::vector<uint8_t>& {
+    return code_;
+  }
+
+ private:
+  std::vector<uint8_t> code_;
+};
+// Layout:
+//   save rdi rsi rdx rcx r8 r9 rax r10 and xmm0-7
+//   r11 = TraceEnter(target, [return address]); restore everything
+//   r11 == 0: jmp original
+//   pop the return address, call original
+//   save rax rdx xmm0 xmm1; r11 = TraceExit(); restore; jmp r11
+// The stack is 16-byte aligned at both helper calls, and the original sees
+// its stack arguments at the same offsets as if it had been called
+// directly.
+static auto BuildTrampoline(TraceTarget* target, void* original) -> void* {
+  constexpr uint32_t kXmmArgs = 8;
+  constexpr uint32_t kXmmSize = 16;
+  constexpr uint32_t kXmmArea = kXmmArgs * kXmmSize + 8;
+  constexpr uint32_t kSavedGprBytes = 8 * 8;
+  constexpr uint32_t kReturnXmmArea = 2 * kXmmSize;
+  TrampolineWriter w;
+  w.Bytes({0x57, 0x56, 0x52, 0x51, 0x41, 0x50, 0x41, 0x51, 0x50, 0x41, 0x52});
+  w.Bytes({0x48, 0x81, 0xEC});
+  w.Imm32(kXmmArea);
+  for (uint8_t i = 0; i < kXmmArgs; ++i) {
+    w.StoreXmm(i, i * kXmmSize);
+  }
+  w.Bytes({0x48, 0xBF});  // movabs rdi, target
+  w.Imm64(target);
+  w.Bytes({0x48, 0x8B, 0xB4, 0x24});  // mov rsi, [rsp + return address]
+  w.Imm32(kXmmArea + kSavedGprBytes);
+  w.Bytes({0x48, 0xB8});  // movabs rax, TraceEnter
+  w.Imm64(reinterpret_cast<void*>(&TraceEnter));
+  w.Bytes({0xFF, 0xD0, 0x49, 0x89, 0xC3});  // call rax; mov r11, rax
+  for (uint8_t i = 0; i < kXmmArgs; ++i) {
+    w.LoadXmm(i, i * kXmmSize);
+  }
+  w.Bytes({0x48, 0x81, 0xC4});
+  w.Imm32(kXmmArea);
+  w.Bytes({0x41, 0x5A, 0x58, 0x41, 0x59, 0x41, 0x58, 0x59, 0x5A, 0x5E, 0x5F});
+  w.Bytes({0x4D, 0x85, 0xDB, 0x0F, 0x84});  // test r11, r11; jz passthrough
+  size_t passthrough_rel = w.Size();
+  w.Imm32(0);
+  w.Bytes({0x48, 0x83, 0xC4, 0x08});  // add rsp, 8
+  w.Bytes({0x49, 0xBB});              // movabs r11, original
+  w.Imm64(original);
+  w.Bytes({0x41, 0xFF, 0xD3});  // call r11
+  w.Bytes({0x50, 0x52, 0x48, 0x83, 0xEC, kReturnXmmArea});
+  w.StoreXmm(0, 0);
+  w.StoreXmm(1, kXmmSize);
+  w.Bytes({0x48, 0xB8});  // movabs rax, TraceExit
+  w.Imm64(reinterpret_cast<void*>(&TraceExit));
+  w.Bytes({0xFF, 0xD0, 0x49, 0x89, 0xC3});  // call rax; mov r11, rax
+  w.LoadXmm(0, 0);
+  w.LoadXmm(1, kXmmSize);
+  w.Bytes({0x48, 0x83, 0xC4, kReturnXmmArea, 0x5A, 0x58});
+  w.Bytes({0x41, 0xFF, 0xE3});  // jmp r11
+  w.PatchRel32(passthrough_rel, w.Size());
+  w.Bytes({0x49, 0xBB});  // movabs r11, original
+  w.Imm64(original);
+  w.Bytes({0x41, 0xFF, 0xE3});  // jmp r11
+  // Own pages per trampoline keep them W^X without ever re-opening a page
+  // another thread may be executing.
+  return MapCode(w.Code());
+}
+// movabs r11, counter; lock inc qword [r11]; movabs r11, target; jmp r11
+// Only r11, which the ABI leaves to PLT stubs, and the flags are touched, so
+// the stub is transparent to any callee, variadic or not.
+constexpr size_t kCensusStubSize = 32;
+static auto WriteCensusStub(TrampolineWriter& w, CensusCounter* counter,
+                            void* target) -> void {
+  size_t begin = w.Size();
+  w.Bytes({0x49, 0xBB});
+  w.Imm64(&counter->calls);
+  w.Bytes({0xF0, 0x49, 0xFF, 0x03});
+  w.Bytes({0x49, 0xBB});
+  w.Imm64(target);
+  w.Bytes({0x41, 0xFF, 0xE3});
+  while (w.Size() - begin < kCensusStubSize) {
+    w.Bytes({0xCC});
+  }
+}
+#endif
+// What the trampoline must call: the current slot target if another hook
+// already owns the slot, otherwise the resolved symbol. An unresolved lazy
+// slot still points into the module's own PLT; calling that would let the
+// resolver overwrite the trampoline.
+static auto ResolveTarget(void** slot_addr, const std::string& symbol)
+    -> void* {
+  void* current = *slot_addr;
+  Dl_info module_info;
+  Dl_info target_info;
+  if (dladdr(static_cast<void*>(slot_addr), &module_info) != 0 &&
+      dladdr(current, &target_info) != 0 &&
+      target_info.dli_fbase == module_info.dli_fbase) {
+    return dlsym(RTLD_DEFAULT, symbol.c_str());
+  }
+  return current;
+}
+static auto FindSlot(const PltHook& hook, const std::string& symbol)
+    -> void** {
+  unsigned int pos = 0;
+  const char* name = nullptr;
+  void** addr = nullptr;
+  while (hook.EnumerateSymbols(pos, name, addr) ==
+         PltHook::ErrorCode::kSuccess) {
+    if (strncmp(name, symbol.c_str(), symbol.size()) == 0 &&
+        (name[symbol.size()] == '\0' || name[symbol.size()] == '@')) {
+      return addr;
+    }
+  }
+  return nullptr;
+}
+}  // namespace tracker
+class FunctionTraceImpl {
+ public:
+  auto Register(const std::string& lib_name) -> void {
+    std::lock_guard<std::mutex> lock(mutex_);
+    modules_.push_back(lib_name);
+  }
+  auto TraceFunction(const std::string& symbol) -> size_t;
+  auto GetStats() const -> std::vector<TracedFunctionStats>;
+  auto StartCensus() -> size_t;
+  auto GetCensus(size_t count) const -> std::vector<ImportCallCount>;
+  auto PrintCensus(size_t count) const -> void;
+  auto Detect() const -> void;
+
+ private:
+  auto TraceInModule(const std::string& module, tracker::TraceSlot* slot)
+      -> bool;
+  auto CensusInModule(const std::string& module) -> void;
+  mutable std::mutex mutex_;
+  std::vector<std::string> modules_;
+  // Slots and trampolines are never freed, not even at exit: a thread may
+  // be inside a trampoline at any time.
+  std::vector<tracker::TraceSlot*> slots_;
+  std::vector<tracker::TraceTarget*> targets_;
+  std::unordered_map<std::string, tracker::TraceSlot*> slot_by_symbol_;
+  std::set<std::pair<std::string, std::string>> traced_;
+  std::vector<tracker::CensusEntry> census_;
+  std::set<std::pair<std::string, std::string>> censused_;
+  std::vector<std::unique_ptr<PltHook>> hooks_;
+};
+auto FunctionTraceImpl::TraceInModule(const std::string& module,
+                                      tracker::TraceSlot* slot) -> bool {
+#if defined(__x86_64__)
+  std::unique_ptr<PltHook> hook;
+  try {
+    hook = PltHook::Create(module.c_str());
+  } catch (const std::exception& e) {
+    TRACKER_ERROR("Cannot trace %s in %s: %s\n", slot->symbol.c_str(),
+                  module.c_str(), e.what());
+    return false;
+  }
+  void** slot_addr = tracker::FindSlot(*hook, slot->symbol);
+  if (slot_addr == nullptr) {
+    return false;
+  }
+  void* target = tracker::ResolveTarget(slot_addr, slot->symbol);
+  if (target == nullptr) {
+    return false;
+  }
+  Dl_info self;
+  Dl_info callee;
+  bool forwards_to_hook =
+      dladdr(reinterpret_cast<void*>(&tracker::TraceEnter), &self) != 0 &&
+      dladdr(target, &callee) != 0 && callee.dli_fbase == self.dli_fbase;
+  auto* trace_target = new tracker::TraceTarget{slot, forwards_to_hook};
+  targets_.push_back(trace_target);
+  void* trampoline = tracker::BuildTrampoline(trace_target, target);
+  if (trampoline == nullptr) {
+    TRACKER_ERROR("Failed to build trampoline for %s\n",
+                  slot->symbol.c_str());
+    return false;
+  }
+  if (hook->ReplaceFunction(slot->symbol.c_str(), trampoline, nullptr) !=
+      PltHook::ErrorCode::kSuccess) {
+    TRACKER_ERROR("Failed to trace %s: %s\n", slot->symbol.c_str(),
+                  PltHook::GetLastError().c_str());
+    return false;
+  }
+  hooks_.push_back(std::move(hook));
+  return true;
+#else
+  (void)module;
+  (void)slot;
+  return false;
+#endif
+}
+auto FunctionTraceImpl::TraceFunction(const std::string& symbol) -> size_t {
+#if !defined(__x86_64__)
+  TRACKER_WARNING("Function tracing is only supported on x86-64\n");
+#endif
+  std::lock_guard<std::mutex> lock(mutex_);
+  tracker::TraceSlot*& slot = slot_by_symbol_[symbol];
+  if (slot == nullptr) {
+    slot = new tracker::TraceSlot();
+    slots_.push_back(slot);
+    slot->symbol = symbol;
+  }
+  size_t traced = 0;
+  for (const auto& module : modules_) {
+    if (traced_.contains({module, symbol})) {
+      ++traced;
+      continue;
+    }
+    if (TraceInModule(module, slot)) {
+      traced_.insert({module, symbol});
+      slot->modules++;
+      ++traced;
+    }
+  }
+  return traced;
+}
+auto FunctionTraceImpl::CensusInModule(const std::string& module) -> void {
+#if defined(__x86_64__)
+  std::unique_ptr<PltHook> hook;
+  try {
+    hook = PltHook::Create(module.c_str());
+  } catch (const std::exception& e) {
+    TRACKER_ERROR("Cannot count calls in %s: %s\n", module.c_str(), e.what());
+    return;
+  }
+  std::vector<tracker::CensusEntry> entries;
+  tracker::TrampolineWriter w;
+  unsigned int pos = 0;
+  const char* name = nullptr;
+  void** addr = nullptr;
+  while (hook->EnumerateSymbols(pos, name, addr) ==
+         PltHook::ErrorCode::kSuccess) {
+    if (censused_.contains({module, name})) {
+      continue;
+    }
+    // Unresolvable slots (weak references such as __gmon_start__) are
+    // never called through.
+    void* target = tracker::ResolveTarget(addr, name);
+    if (target == nullptr) {
+      continue;
+    }
+    auto* counter = new tracker::CensusCounter();
+    tracker::WriteCensusStub(w, counter, target);
+    entries.push_back({module, name, counter});
+  }
+  if (entries.empty()) {
+    return;
+  }
+  auto* stubs = static_cast<uint8_t*>(tracker::MapCode(w.Code()));
+  if (stubs == nullptr) {
+    TRACKER_ERROR("Failed to map call census stubs for %s\n", module.c_str());
+    return;
+  }
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (hook->ReplaceFunction(entries[i].symbol.c_str(),
+                              stubs + i * tracker::kCensusStubSize,
+                              nullptr) != PltHook::ErrorCode::kSuccess) {
+      continue;
+    }
+    censused_.insert({module, entries[i].symbol});
+    census_.push_back(std::move(entries[i]));
+  }
+  hooks_.push_back(std::move(hook));
+#else
+  (void)module;
+#endif
+}
+auto FunctionTraceImpl::StartCensus() -> size_t {
+#if !defined(__x86_64__)
+  TRACKER_WARNING("Call census is only supported on x86-64\n");
+#endif
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& module : modules_) {
+    CensusInModule(module);
+  }
+  return census_.size();
+}
+auto FunctionTraceImpl::GetCensus(size_t count) const
+    -> std::vector<ImportCallCount> {
+  std::vector<ImportCallCount> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(census_.size());
+    for (const auto& entry : census_) {
+      result.push_back({entry.module, entry.symbol,
+                        entry.counter->calls.load(std::memory_order_relaxed)});
+    }
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](const ImportCallCount& a, const ImportCallCount& b) {
+                     return a.calls > b.calls;
+                   });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+// Top `count` imports of each module, modules in order of registration.
+auto FunctionTraceImpl::PrintCensus(size_t count) const -> void {
+  std::vector<ImportCallCount> census = GetCensus(SIZE_MAX);
+  if (census.empty()) {
+    return;
+  }
+  std::vector<std::string> modules;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    modules = modules_;
+  }
+  tracker::ReportSection section;
+  TRACKER_PRINT("\n\n=== Import Call Census ===\n");
+  for (const auto& module : modules) {
+    uint64_t total = 0;
+    for (const auto& entry : census) {
+      if (entry.module == module) {
+        total += entry.calls;
+      }
+    }
+    TRACKER_PRINT("%s: %lu calls\n", module.empty() ? "main" : module.c_str(),
+                  total);
+    size_t printed = 0;
+    for (const auto& entry : census) {
+      if (entry.module != module || entry.calls == 0) {
+        continue;
+      }
+      if (printed++ == count) {
+        break;
+      }
+      constexpr double kPercent = 100.0;
+      TRACKER_PRINT("  %-32s %14lu %6.2f%%\n", entry.symbol.c_str(),
+                    entry.calls,
+                    kPercent * static_cast<double>(entry.calls) /
+                        static_cast<double>(total));
+    }
+  }
+  TRACKER_PRINT("===========================\n");
+}
+auto FunctionTraceImpl::GetStats() const -> std::vector<TracedFunctionStats> {
+  std::vector<TracedFunctionStats> result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& slot : slots_) {
+    TracedFunctionStats stats;
+    stats.symbol = slot->symbol;
+    stats.modules = slot->modules;
+    stats.calls = slot->calls.load(std::memory_order_relaxed);
+    stats.total_ns = slot->total_ns.load(std::memory_order_relaxed);
+    stats.max_ns = slot->max_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kLatencyBuckets; ++i) {
+      stats.latency[i] = slot->latency[i].load(std::memory_order_relaxed);
+    }
+    result.push_back(std::move(stats));
+  }
+  return result;
+}
+auto FunctionTraceImpl::Detect() const -> void {
+  constexpr size_t kCensusReportCount = 20;
+  PrintCensus(kCensusReportCount);
+  constexpr double kNsPerUs = 1000.0;
+  constexpr double kP50 = 0.5;
+  constexpr double kP99 = 0.99;
+  std::vector<TracedFunctionStats> stats = GetStats();
+  if (stats.empty()) {
+    return;
+  }
+  tracker::ReportSection section;
+  TRACKER_PRINT("\n\n=== Traced Functions ===\n");
+  for (const auto& entry : stats) {
+    double avg_us = entry.calls == 0
+                        ? 0.0
+                        : static_cast<double>(entry.total_ns) /
+                              static_cast<double>(entry.calls) / kNsPerUs;
+    TRACKER_PRINT(
+        "%s (%zu modules): calls: %zu, avg: %.2f us, p50: %.2f us, "
+        "p99: %.2f us, max: %.2f us\n",
+        entry.symbol.c_str(), entry.modules, entry.calls, avg_us,
+        static_cast<double>(
+            LatencyPercentile(entry.latency, kP50, entry.max_ns)) /
+            kNsPerUs,
+        static_cast<double>(
+            LatencyPercentile(entry.latency, kP99, entry.max_ns)) /
+            kNsPerUs,
+        static_cast<double>(entry.max_ns) / kNsPerUs);
+  }
+  TRACKER_PRINT("===========================\n");
+}
+FunctionTrace::FunctionTrace() : impl_(std::make_unique<FunctionTraceImpl>()) {}
+FunctionTrace::~FunctionTrace() = default;
+auto FunctionTrace::Register(const std::string& lib_name) -> void {
+  impl_->Register(lib_name);
+}
+auto FunctionTrace::RegisterMain() -> void { impl_->Register(std::string()); }
+auto FunctionTrace::TraceFunction(const std::string& symbol) -> size_t {
+  return impl_->TraceFunction(symbol);
+}
+auto FunctionTrace::GetStats() const -> std::vector<TracedFunctionStats> {
+  return impl_->GetStats();
+}
+auto FunctionTrace::StartCensus() -> size_t { return impl_->StartCensus(); }
+auto FunctionTrace::GetCensus(size_t count) const
+    -> std::vector<ImportCallCount> {
+  return impl_->GetCensus(count);
+}
+auto FunctionTrace::PrintCensus(size_t count) -> void {
+  impl_->PrintCensus(count);
+}
+auto FunctionTrace::Detect() -> void { impl_->Detect(); }
@@ -0,0 +1,647 @@
+#include "io_detect.h"
+
+#include <arpa/inet.h>
+#include <dlfcn.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "output_control.h"
+#include "overhead.h"
+#include "plthook.h"
+auto IoOpName(IoOp op) -> const char* {
+  switch (op) {
+    case IoOp::kRead:
+      return "read";
+    case IoOp::kWrite:
+      return "write";
+    case IoOp::kPread:
+      return "pread";
+    case IoOp::kPwrite:
+      return "pwrite";
+    case IoOp::kReadv:
+      return "readv";
+    case IoOp::kWritev:
+      return "writev";
+    case IoOp::kFsync:
+      return "fsync";
+    case IoOp::kFdatasync:
+      return "fdatasync";
+    case IoOp::kSend:
+      return "send";
+    case IoOp::kRecv:
+      return "recv";
+    case IoOp::kSendmsg:
+      return "sendmsg";
+    case IoOp::kRecvmsg:
+      return "recvmsg";
+    case IoOp::kCount:
+      break;
+  }
+  return "?";
+}
+namespace tracker {
+static auto IsReadOp(IoOp op) -> bool {
+  return op == IoOp::kRead || op == IoOp::kPread || op == IoOp::kReadv ||
+         op == IoOp::kRecv || op == IoOp::kRecvmsg;
+}
+static auto IsSyncOp(IoOp op) -> bool {
+  return op == IoOp::kFsync || op == IoOp::kFdatasync;
+}
+static auto FormatPeer(const struct sockaddr_storage& addr, socklen_t len)
+    -> std::string {
+  char text[INET6_ADDRSTRLEN] = {};
+  // Room for "[addr]:port" and "unix:" plus a full sun_path.
+  char peer[sizeof(text) + sizeof(sockaddr_un::sun_path) + 16] = {};
+  switch (addr.ss_family) {
+    case AF_INET: {
+      const auto* in = reinterpret_cast<const struct sockaddr_in*>(&addr);
+      inet_ntop(AF_INET, &in->sin_addr, text, sizeof(text));
+      snprintf(peer, sizeof(peer), "%s:%u", text, ntohs(in->sin_port));
+      break;
+    }
+    case AF_INET6: {
+      const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(&addr);
+      inet_ntop(AF_INET6, &in6->sin6_addr, text, sizeof(text));
+      snprintf(peer, sizeof(peer), "[%s]:%u", text, ntohs(in6->sin6_port));
+      break;
+    }
+    case AF_UNIX: {
+      const auto* un = reinterpret_cast<const struct sockaddr_un*>(&addr);
+      size_t path_len = len > offsetof(struct sockaddr_un, sun_path)
+                            ? len - offsetof(struct sockaddr_un, sun_path)
+                            : 0;
+      // socketpair ends and abstract names have no printable path
+      if (path_len == 0 || un->sun_path[0] == '\0') {
+        return "unix";
+      }
+      snprintf(peer, sizeof(peer), "unix:%.*s",
+               static_cast<int>(strnlen(un->sun_path, path_len)),
+               un->sun_path);
+      break;
+    }
+    default:
+      snprintf(peer, sizeof(peer), "family %u", addr.ss_family);
+      break;
+  }
+  return peer;
+}
+static auto IsSocket(int fd) -> bool {
+  struct stat info {};
+  return fstat(fd, &info) == 0 && S_ISSOCK(info.st_mode);
+}
+static auto ProbePeer(int fd) -> std::string {
+  struct sockaddr_storage addr {};
+  socklen_t len = sizeof(addr);
+  return getpeername(fd, reinterpret_cast<struct sockaddr*>(&addr), &len) == 0
+             ? FormatPeer(addr, len)
+             : "unconnected";
+}
+class IoTracker {
+ public:
+  static auto GetInstance() -> IoTracker& {
+    static IoTracker instance;
+    return instance;
+  }
+  IoTracker(const IoTracker&) = delete;
+  auto operator=(const IoTracker&) -> IoTracker& = delete;
+  auto RecordCall(IoOp op, void* site, int fd, ssize_t result,
+                  uint64_t latency_ns) -> void;
+  auto GetCounters() const -> IoCounters {
+    return {calls_.load(std::memory_order_relaxed),
+            bytes_read_.load(std::memory_order_relaxed),
+            bytes_written_.load(std::memory_order_relaxed),
+            errors_.load(std::memory_order_relaxed),
+            total_ns_.load(std::memory_order_relaxed)};
+  }
+  auto GetSlowestSites(size_t count) const -> std::vector<IoSiteStats>;
+  auto GetBusiestFds(size_t count) const -> std::vector<IoFdStats>;
+  auto GetBusiestSockets(size_t count) const -> std::vector<IoSocketStats>;
+  auto PrintStatus(size_t count) const -> void;
+
+ private:
+  IoTracker() = default;
+  mutable std::mutex mutex_;
+  std::unordered_map<void*, IoSiteStats> sites_;
+  std::unordered_map<int, IoFdStats> fds_;
+  // Descriptors that are not sockets stay here too. Each is probed once,
+  // and again only after its number was closed or dup'ed over, i.e. when
+  // FdGeneration moved on.
+  struct SocketEntry {
+    uint32_t generation = 0;
+    bool is_socket = false;
+    IoSocketStats stats;
+  };
+  std::unordered_map<int, SocketEntry> sockets_;
+  // Connections whose descriptor was since reused, busiest first, capped at
+  // kRetiredSockets.
+  static constexpr size_t kRetiredSockets = 64;
+  std::vector<IoSocketStats> retired_sockets_;
+  auto RetireSocket(IoSocketStats&& stats) -> void;
+  std::atomic<size_t> calls_ = 0;
+  std::atomic<size_t> bytes_read_ = 0;
+  std::atomic<size_t> bytes_written_ = 0;
+  std::atomic<size_t> errors_ = 0;
+  std::atomic<uint64_t> total_ns_ = 0;
+};
+static auto Instance() -> IoTracker& { return IoTracker::GetInstance(); }
+auto IoTracker::RecordCall(IoOp op, void* site, int fd, ssize_t result,
+                           uint64_t latency_ns) -> void {
+  size_t bytes = result > 0 ? static_cast<size_t>(result) : 0;
+  bool is_read = IsReadOp(op);
+  calls_.fetch_add(1, std::memory_order_relaxed);
+  total_ns_.fetch_add(latency_ns, std::memory_order_relaxed);
+  (is_read ? bytes_read_ : bytes_written_)
+      .fetch_add(bytes, std::memory_order_relaxed);
+  if (result < 0) {
+    errors_.fetch_add(1, std::memory_order_relaxed);
+  }
+  size_t bucket = LatencyBucket(latency_ns);
+  bool track_socket = !IsSyncOp(op) && result >= 0;
+  uint32_t generation = FdGeneration(fd);
+  PhaseScope table(OverheadPhase::kTable);
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto& site_stats = sites_[site];
+  site_stats.site = site;
+  site_stats.op = op;
+  site_stats.calls++;
+  site_stats.bytes += bytes;
+  site_stats.errors += result < 0 ? 1 : 0;
+  site_stats.total_ns += latency_ns;
+  site_stats.max_ns = std::max(site_stats.max_ns, latency_ns);
+  site_stats.latency[bucket]++;
+  auto& fd_stats = fds_[fd];
+  fd_stats.fd = fd;
+  fd_stats.calls++;
+  (is_read ? fd_stats.bytes_read : fd_stats.bytes_written) += bytes;
+  fd_stats.total_ns += latency_ns;
+  fd_stats.max_ns = std::max(fd_stats.max_ns, latency_ns);
+  fd_stats.latency[bucket]++;
+  if (!track_socket) {
+    return;
+  }
+  auto socket = sockets_.find(fd);
+  if (socket == sockets_.end() || socket->second.generation != generation) {
+    // fstat and getpeername are syscalls; keep them out of the lock.
+    lock.unlock();
+    SocketEntry entry;
+    entry.generation = generation;
+    entry.is_socket = IsSocket(fd);
+    entry.stats.fd = fd;
+    if (entry.is_socket) {
+      entry.stats.peer = ProbePeer(fd);
+    }
+    lock.lock();
+    socket = sockets_.find(fd);
+    if (socket == sockets_.end()) {
+      socket = sockets_.try_emplace(fd, std::move(entry)).first;
+    } else if (socket->second.generation != generation) {
+      if (socket->second.is_socket) {
+        RetireSocket(std::move(socket->second.stats));
+      }
+      socket->second = std::move(entry);
+    }
+  }
+  if (!socket->second.is_socket) {
+    return;
+  }
+  auto& socket_stats = socket->second.stats;
+  if (is_read) {
+    socket_stats.reads++;
+    socket_stats.bytes_read += bytes;
+  } else {
+    socket_stats.writes++;
+    socket_stats.bytes_written += bytes;
+    socket_stats.tiny_writes += bytes < kIoTinyWriteBytes ? 1 : 0;
+  }
+}
+auto IoTracker::RetireSocket(IoSocketStats&& stats) -> void {
+  auto busier = [](const auto& lhs, const auto& rhs) {
+    return lhs.bytes_read + lhs.bytes_written >
+           rhs.bytes_read + rhs.bytes_written;
+  };
+  auto at = std::ranges::upper_bound(retired_sockets_, stats, busier);
+  if (retired_sockets_.size() == kRetiredSockets) {
+    if (at == retired_sockets_.end()) {
+      return;
+    }
+    retired_sockets_.pop_back();
+  }
+  retired_sockets_.insert(at, std::move(stats));
+}
+auto IoTracker::GetSlowestSites(size_t count) const
+    -> std::vector<IoSiteStats> {
+  constexpr double kP99 = 0.99;
+  std::vector<IoSiteStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(sites_.size());
+    for (const auto& pair : sites_) {
+      result.push_back(pair.second);
+    }
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    uint64_t lhs_p99 = LatencyPercentile(lhs.latency, kP99, lhs.max_ns);
+    uint64_t rhs_p99 = LatencyPercentile(rhs.latency, kP99, rhs.max_ns);
+    if (lhs_p99 != rhs_p99) {
+      return lhs_p99 > rhs_p99;
+    }
+    return lhs.total_ns > rhs.total_ns;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto IoTracker::GetBusiestFds(size_t count) const -> std::vector<IoFdStats> {
+  std::vector<IoFdStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(fds_.size());
+    for (const auto& pair : fds_) {
+      result.push_back(pair.second);
+    }
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.total_ns > rhs.total_ns;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto IoTracker::GetBusiestSockets(size_t count) const
+    -> std::vector<IoSocketStats> {
+  std::vector<IoSocketStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& pair : sockets_) {
+      if (pair.second.is_socket) {
+        result.push_back(pair.second.stats);
+      }
+    }
+    result.insert(result.end(), retired_sockets_.begin(),
+                  retired_sockets_.end());
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.bytes_read + lhs.bytes_written >
+           rhs.bytes_read + rhs.bytes_written;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto IoTracker::PrintStatus(size_t count) const -> void {
+  constexpr double kNsPerUs = 1000.0;
+  constexpr double kNsPerMs = 1000000.0;
+  constexpr double kP99 = 0.99;
+  constexpr double kP999 = 0.999;
+  // Too few writes to be worth batching.
+  constexpr size_t kTinyWriteMinCalls = 100;
+  IoCounters counters = GetCounters();
+  std::vector<IoSiteStats> sites = GetSlowestSites(count);
+  std::vector<IoFdStats> fds = GetBusiestFds(count);
+  std::vector<IoSocketStats> sockets = GetBusiestSockets(count);
+  ReportSection section;
+  TRACKER_PRINT("\n\n=== I/O Profile ===\n");
+  TRACKER_PRINT("Calls: %zu, read: %zu bytes, written: %zu bytes, errors: %zu, "
+                "time: %.2f ms\n",
+                counters.calls, counters.bytes_read, counters.bytes_written,
+                counters.errors,
+                static_cast<double>(counters.total_ns) / kNsPerMs);
+  if (!sites.empty()) {
+    TRACKER_PRINT("\nSlowest I/O sites (by p99):\n");
+  }
+  for (size_t i = 0; i < sites.size(); ++i) {
+    const auto& site = sites[i];
+    Dl_info dlinfo;
+    const char* symbol = "??";
+    const char* module = "??";
+    if (site.site != nullptr && dladdr(site.site, &dlinfo) != 0) {
+      symbol = dlinfo.dli_sname != nullptr ? dlinfo.dli_sname : symbol;
+      module = dlinfo.dli_fname != nullptr ? dlinfo.dli_fname : module;
+    }
+    uint64_t p99 = LatencyPercentile(site.latency, kP99, site.max_ns);
+    uint64_t p999 = LatencyPercentile(site.latency, kP999, site.max_ns);
+    TRACKER_PRINT("[%zu] %s at %p %s (%s)\n", i, IoOpName(site.op), site.site,
+                  symbol, module);
+    TRACKER_PRINT(
+        "    calls: %zu, bytes: %zu, errors: %zu, avg: %.1f us, p99: %.1f us, "
+        "p999: %.1f us, max: %.1f us\n",
+        site.calls, site.bytes, site.errors,
+        static_cast<double>(site.total_ns) /
+            static_cast<double>(site.calls) / kNsPerUs,
+        static_cast<double>(p99) / kNsPerUs,
+        static_cast<double>(p999) / kNsPerUs,
+        static_cast<double>(site.max_ns) / kNsPerUs);
+  }
+  if (!fds.empty()) {
+    TRACKER_PRINT("\nBusiest file descriptors:\n");
+  }
+  for (const auto& fd : fds) {
+    uint64_t p99 = LatencyPercentile(fd.latency, kP99, fd.max_ns);
+    TRACKER_PRINT(
+        "  fd %d: calls: %zu, read: %zu bytes, written: %zu bytes, time: "
+        "%.2f ms, p99: %.1f us, max: %.1f us\n",
+        fd.fd, fd.calls, fd.bytes_read, fd.bytes_written,
+        static_cast<double>(fd.total_ns) / kNsPerMs,
+        static_cast<double>(p99) / kNsPerUs,
+        static_cast<double>(fd.max_ns) / kNsPerUs);
+  }
+  if (!sockets.empty()) {
+    TRACKER_PRINT("\nSockets by bytes:\n");
+  }
+  for (const auto& socket : sockets) {
+    auto average = [](size_t bytes, size_t calls) {
+      return calls == 0 ? 0.0
+                        : static_cast<double>(bytes) /
+                              static_cast<double>(calls);
+    };
+    TRACKER_PRINT(
+        "  fd %d %s: writes: %zu (%zu bytes, avg %.1f), reads: %zu (%zu "
+        "bytes, avg %.1f)\n",
+        socket.fd, socket.peer.c_str(), socket.writes, socket.bytes_written,
+        average(socket.bytes_written, socket.writes), socket.reads,
+        socket.bytes_read, average(socket.bytes_read, socket.reads));
+    if (socket.writes >= kTinyWriteMinCalls &&
+        socket.tiny_writes * 2 >= socket.writes) {
+      TRACKER_PRINT(
+          "    many tiny writes: %zu of %zu under %zu bytes; batch them "
+          "(writev, sendmsg) or use TCP_CORK / MSG_MORE\n",
+          socket.tiny_writes, socket.writes, kIoTinyWriteBytes);
+    }
+  }
+  TRACKER_PRINT("===========================\n");
+}
+}  // namespace tracker
+// Shared tail of every I/O hook. Keeps errno intact for the caller, since
+// recording may allocate.
+static auto RecordIo(IoOp op, tracker::HookKind kind, void* site, int fd,
+                     ssize_t result,
+                     std::chrono::steady_clock::time_point start) -> void {
+  auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+  int saved_errno = errno;
+  {
+    tracker::HookScope scope(kind);
+    tracker::Instance().RecordCall(op, site, fd, result,
+                                   static_cast<uint64_t>(latency.count()));
+  }
+  errno = saved_errno;
+}
+static auto HookedRead(int fd, void* buf, size_t count) -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = read(fd, buf, count);
+  RecordIo(IoOp::kRead, tracker::HookKind::kRead, site, fd, result, start);
+  return result;
+}
+static auto HookedWrite(int fd, const void* buf, size_t count) -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = write(fd, buf, count);
+  RecordIo(IoOp::kWrite, tracker::HookKind::kWrite, site, fd, result, start);
+  return result;
+}
+static auto HookedPread(int fd, void* buf, size_t count, off_t offset)
+    -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = pread(fd, buf, count, offset);
+  RecordIo(IoOp::kPread, tracker::HookKind::kPread, site, fd, result, start);
+  return result;
+}
+static auto HookedPwrite(int fd, const void* buf, size_t count, off_t offset)
+    -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = pwrite(fd, buf, count, offset);
+  RecordIo(IoOp::kPwrite, tracker::HookKind::kPwrite, site, fd, result, start);
+  return result;
+}
+static auto HookedReadv(int fd, const struct iovec* iov, int iovcnt)
+    -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = readv(fd, iov, iovcnt);
+  RecordIo(IoOp::kReadv, tracker::HookKind::kReadv, site, fd, result, start);
+  return result;
+}
+static auto HookedWritev(int fd, const struct iovec* iov, int iovcnt)
+    -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = writev(fd, iov, iovcnt);
+  RecordIo(IoOp::kWritev, tracker::HookKind::kWritev, site, fd, result, start);
+  return result;
+}
+static auto HookedFsync(int fd) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = fsync(fd);
+  RecordIo(IoOp::kFsync, tracker::HookKind::kFsync, site, fd, result, start);
+  return result;
+}
+static auto HookedFdatasync(int fd) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  int result = fdatasync(fd);
+  RecordIo(IoOp::kFdatasync, tracker::HookKind::kFdatasync, site, fd, result,
+           start);
+  return result;
+}
+static auto HookedSend(int fd, const void* buf, size_t len, int flags)
+    -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = send(fd, buf, len, flags);
+  RecordIo(IoOp::kSend, tracker::HookKind::kSend, site, fd, result, start);
+  return result;
+}
+static auto HookedRecv(int fd, void* buf, size_t len, int flags) -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = recv(fd, buf, len, flags);
+  RecordIo(IoOp::kRecv, tracker::HookKind::kRecv, site, fd, result, start);
+  return result;
+}
+static auto HookedSendmsg(int fd, const struct msghdr* msg, int flags)
+    -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = sendmsg(fd, msg, flags);
+  RecordIo(IoOp::kSendmsg, tracker::HookKind::kSendmsg, site, fd, result,
+           start);
+  return result;
+}
+static auto HookedRecvmsg(int fd, struct msghdr* msg, int flags) -> ssize_t {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto start = std::chrono::steady_clock::now();
+  ssize_t result = recvmsg(fd, msg, flags);
+  RecordIo(IoOp::kRecvmsg, tracker::HookKind::kRecvmsg, site, fd, result,
+           start);
+  return result;
+}
+// Only mark the number as reused; the descriptor detector, which starts
+// later, replaces these with its own hooks that do the same.
+static auto HookedClose(int fd) -> int {
+  tracker::BumpFdGeneration(fd);
+  return close(fd);
+}
+static auto HookedDup2(int oldfd, int newfd) -> int {
+  if (oldfd != newfd) {
+    tracker::BumpFdGeneration(newfd);
+  }
+  return dup2(oldfd, newfd);
+}
+static auto HookedDup3(int oldfd, int newfd, int flags) -> int {
+  tracker::BumpFdGeneration(newfd);
+  return dup3(oldfd, newfd, flags);
+}
+class IoHook {
+ public:
+  explicit IoHook(std::string lib_path) : lib_path_(std::move(lib_path)) {}
+  ~IoHook() = default;
+  auto Start() -> void;
+
+ private:
+  std::string lib_path_;
+  std::unique_ptr<PltHook> hook_;
+};
+auto IoHook::Start() -> void {
+  hook_ = PltHook::Create(lib_path_.c_str());
+  try {
+    std::vector<std::string> hooked_functions;
+    auto try_hook = [&](const char* symbol, void* hook_func) {
+      if (hook_->ReplaceFunction(symbol, hook_func, nullptr) ==
+          PltHook::ErrorCode::kSuccess) {
+        hooked_functions.emplace_back(symbol);
+      }
+    };
+    try_hook("read", reinterpret_cast<void*>(&HookedRead));
+    try_hook("write", reinterpret_cast<void*>(&HookedWrite));
+    // Large-file builds import the 64-bit names; on LP64 they are the same
+    // functions.
+    try_hook("pread", reinterpret_cast<void*>(&HookedPread));
+    try_hook("pread64", reinterpret_cast<void*>(&HookedPread));
+    try_hook("pwrite", reinterpret_cast<void*>(&HookedPwrite));
+    try_hook("pwrite64", reinterpret_cast<void*>(&HookedPwrite));
+    try_hook("readv", reinterpret_cast<void*>(&HookedReadv));
+    try_hook("writev", reinterpret_cast<void*>(&HookedWritev));
+    try_hook("fsync", reinterpret_cast<void*>(&HookedFsync));
+    try_hook("fdatasync", reinterpret_cast<void*>(&HookedFdatasync));
+    try_hook("send", reinterpret_cast<void*>(&HookedSend));
+    try_hook("recv", reinterpret_cast<void*>(&HookedRecv));
+    try_hook("sendmsg", reinterpret_cast<void*>(&HookedSendmsg));
+    try_hook("recvmsg", reinterpret_cast<void*>(&HookedRecvmsg));
+    try_hook("close", reinterpret_cast<void*>(&HookedClose));
+    try_hook("dup2", reinterpret_cast<void*>(&HookedDup2));
+    try_hook("dup3", reinterpret_cast<void*>(&HookedDup3));
+    tracker::ReportSection section;
+    auto& output = tracker::OutputControl::Instance();
+    output.PrintColored(tracker::Color::kGreen, tracker::Color::kReset,
+                        "Hooked I/O functions: ");
+    for (size_t i = 0; i < hooked_functions.size(); ++i) {
+      TRACKER_PRINT("%s", hooked_functions[i].c_str());
+      if (i < hooked_functions.size() - 1) {
+        TRACKER_PRINT(", ");
+      }
+    }
+    TRACKER_PRINT("\n");
+  } catch (const std::exception& e) {
+    TRACKER_ERROR("Error starting I/O tracking: %s", e.what());
+  }
+}
+class IoDetectImpl {
+ public:
+  IoDetectImpl() = default;
+  ~IoDetectImpl() = default;
+  auto Register(const std::string& lib_name) -> void;
+  auto RegisterMain() -> void;
+  auto Start() -> void;
+  auto Detect() -> void;
+  auto GetCounters() const -> IoCounters;
+  auto GetSlowestSites(size_t count) const -> std::vector<IoSiteStats>;
+  auto GetBusiestFds(size_t count) const -> std::vector<IoFdStats>;
+  auto GetBusiestSockets(size_t count) const -> std::vector<IoSocketStats>;
+  auto PrintSlowestSites(size_t count) -> void;
+
+ private:
+  std::vector<std::unique_ptr<IoHook>> hooks_;
+};
+auto IoDetectImpl::Register(const std::string& lib_name) -> void {
+  hooks_.emplace_back(std::make_unique<IoHook>(lib_name));
+}
+auto IoDetectImpl::RegisterMain() -> void {
+  hooks_.emplace_back(std::make_unique<IoHook>(std::string()));
+}
+auto IoDetectImpl::Start() -> void {
+  tracker::Instance();
+  tracker::OverheadAccounting::Instance().Start();
+  for (auto& hook : hooks_) {
+    hook->Start();
+  }
+}
+auto IoDetectImpl::Detect() -> void {
+  constexpr size_t kReportCount = 10;
+  tracker::Instance().PrintStatus(kReportCount);
+}
+auto IoDetectImpl::GetCounters() const -> IoCounters {
+  return tracker::Instance().GetCounters();
+}
+auto IoDetectImpl::GetSlowestSites(size_t count) const
+    -> std::vector<IoSiteStats> {
+  return tracker::Instance().GetSlowestSites(count);
+}
+auto IoDetectImpl::GetBusiestFds(size_t count) const
+    -> std::vector<IoFdStats> {
+  return tracker::Instance().GetBusiestFds(count);
+}
+auto IoDetectImpl::GetBusiestSockets(size_t count) const
+    -> std::vector<IoSocketStats> {
+  return tracker::Instance().GetBusiestSockets(count);
+}
+auto IoDetectImpl::PrintSlowestSites(size_t count) -> void {
+  tracker::Instance().PrintStatus(count);
+}
+IoDetect::IoDetect() : impl_(std::make_unique<IoDetectImpl>()) {}
+IoDetect::~IoDetect() = default;
+auto IoDetect::Register(const std::string& lib_name) -> void {
+  impl_->Register(lib_name);
+}
+auto IoDetect::RegisterMain() -> void { impl_->RegisterMain(); }
+auto IoDetect::Start() -> void { impl_->Start(); }
+auto IoDetect::Detect() -> void { impl_->Detect(); }
+auto IoDetect::GetCounters() const -> IoCounters {
+  return impl_->GetCounters();
+}
+auto IoDetect::GetSlowestSites(size_t count) const
+    -> std::vector<IoSiteStats> {
+  return impl_->GetSlowestSites(count);
+}
+auto IoDetect::GetBusiestFds(size_t count) const -> std::vector<IoFdStats> {
+  return impl_->GetBusiestFds(count);
+}
+auto IoDetect::GetBusiestSockets(size_t count) const
+    -> std::vector<IoSocketStats> {
+  return impl_->GetBusiestSockets(count);
+}
+auto IoDetect::PrintSlowestSites(size_t count) -> void {
+  impl_->PrintSlowestSites(count);
+}
@@ -0,0 +1,20 @@
+#include "latency_histogram.h"
+auto LatencyPercentile(const LatencyHistogram& histogram, double fraction,
+                       uint64_t max_ns) -> uint64_t {
+  uint64_t total = 0;
+  for (uint64_t count : histogram) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(fraction * static_cast<double>(total));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < histogram.size(); ++i) {
+    seen += histogram[i];
+    if (seen > rank) {
+      return std::min(uint64_t{1} << i, max_ns);
+    }
+  }
+  return std::min(uint64_t{1} << (histogram.size() - 1), max_ns);
+}
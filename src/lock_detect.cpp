@@ -2,9 +2,13 @@
 
 #include <dlfcn.h>
 #include <execinfo.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <memory>
 #include <mutex>
@@ -15,6 +19,7 @@
 #include <vector>
 
 #include "output_control.h"
+#include "overhead.h"
 #include "plthook.h"
 namespace tracker {
 struct LockInfo {
@@ -28,6 +33,17 @@ struct ThreadInfo {
   std::vector<void*> held_locks;
   std::vector<void*> waiting_locks;
 };
+// Point-in-time copy of the tracker state. Taken under the tracker lock and
+// formatted afterwards, so reporting never holds up locking threads.
+struct LockSnapshot {
+  std::unordered_map<void*, LockInfo> active_locks;
+  std::unordered_map<pthread_t, ThreadInfo> thread_info;
+  size_t acquisitions = 0;
+  size_t contended_acquisitions = 0;
+  size_t deadlocks_detected = 0;
+  uint64_t total_wait_ns = 0;
+  std::unordered_map<void*, LockStats> lock_stats;
+};
 class LockTracker {
  public:
   static auto GetInstance() -> LockTracker& {
@@ -40,12 +56,17 @@ class LockTracker {
     if (mutex == nullptr) {
       return;
     }
+    PhaseScope bookkeeping(OverheadPhase::kLockBookkeeping);
     std::lock_guard<std::mutex> lock(mutex_);
     void* lock_addr = static_cast<void*>(mutex);
     pthread_t thread_id = pthread_self();
     auto it = active_locks_.find(lock_addr);
     if (it != active_locks_.end()) {
       if (it->second.acquired) {
+        contended_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+        LockStats& stats = StatsFor(lock_addr);
+        stats.contended_acquisitions++;
+        thread_wait_[CurrentTid()].contended_acquisitions++;
         auto& waiting_thread_info = thread_info_[thread_id];
         waiting_thread_info.waiting_locks.push_back(lock_addr);
         for (void* held_lock : waiting_thread_info.held_locks) {
@@ -58,16 +79,31 @@ class LockTracker {
       LockInfo& info = active_locks_[lock_addr];
       info.lock_addr = lock_addr;
       info.acquired = false;
-      GetCallStack(info.callstack);
+      if (ShouldCaptureStack()) {
+        PhaseScope unwind(OverheadPhase::kUnwind);
+        GetCallStack(info.callstack);
+      }
     }
   }
-  auto RecordLockAcquired(pthread_mutex_t* mutex) -> void {
+  auto RecordLockAcquired(pthread_mutex_t* mutex, uint64_t wait_ns) -> void {
     if (mutex == nullptr) {
       return;
     }
+    PhaseScope bookkeeping(OverheadPhase::kLockBookkeeping);
     std::lock_guard<std::mutex> lock(mutex_);
     void* lock_addr = static_cast<void*>(mutex);
     pthread_t thread_id = pthread_self();
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    total_wait_ns_.fetch_add(wait_ns, std::memory_order_relaxed);
+    LockStats& stats = StatsFor(lock_addr);
+    stats.acquisitions++;
+    stats.wait_ns += wait_ns;
+    stats.max_wait_ns = std::max(stats.max_wait_ns, wait_ns);
+    pid_t tid = CurrentTid();
+    auto& thread_wait = thread_wait_[tid];
+    thread_wait.tid = tid;
+    thread_wait.acquisitions++;
+    thread_wait.wait_ns += wait_ns;
     auto it = active_locks_.find(lock_addr);
     if (it != active_locks_.end()) {
       it->second.owner_thread = thread_id;
@@ -78,10 +114,20 @@ class LockTracker {
       std::erase(waiting_locks, lock_addr);
     }
   }
+  // A destroyed mutex's address may be reused by an unrelated one; its
+  // stats must not carry over.
+  auto RecordLockDestroy(pthread_mutex_t* mutex) -> void {
+    PhaseScope bookkeeping(OverheadPhase::kLockBookkeeping);
+    std::lock_guard<std::mutex> lock(mutex_);
+    void* lock_addr = static_cast<void*>(mutex);
+    lock_stats_.erase(lock_addr);
+    active_locks_.erase(lock_addr);
+  }
   auto RecordLockRelease(pthread_mutex_t* mutex) -> void {
     if (mutex == nullptr) {
       return;
     }
+    PhaseScope bookkeeping(OverheadPhase::kLockBookkeeping);
     std::lock_guard<std::mutex> lock(mutex_);
     void* lock_addr = static_cast<void*>(mutex);
     pthread_t thread_id = pthread_self();
@@ -95,10 +141,44 @@ class LockTracker {
       }
     }
   }
+  auto TakeSnapshot() const -> LockSnapshot;
+  auto GetCounters() const -> LockCounters {
+    return {acquisitions_.load(std::memory_order_relaxed),
+            contended_acquisitions_.load(std::memory_order_relaxed),
+            deadlocks_detected_.load(std::memory_order_relaxed),
+            total_wait_ns_.load(std::memory_order_relaxed)};
+  }
+  auto GetLockStats(size_t count) const -> std::vector<LockStats>;
+  auto GetThreadWaitStats(size_t count) const -> std::vector<ThreadWaitStats>;
+  auto GetMetadataBytes() const -> size_t;
+  auto SetStackSamplePeriod(uint32_t period) -> void {
+    stack_sample_period_.store(std::max<uint32_t>(period, 1),
+                               std::memory_order_relaxed);
+  }
+  auto GetStackSamplePeriod() const -> uint32_t {
+    return stack_sample_period_.load(std::memory_order_relaxed);
+  }
   auto PrintStatus() const -> void;
+  auto PrintIncrementalStatus() -> void;
+  auto PrintContention(size_t count) const -> void;
+  auto Checkpoint() -> void;
+  auto PrintDiff() -> void;
 
  private:
   LockTracker() = default;
+  // gettid() is a real syscall; cache it per thread
+  static auto CurrentTid() -> pid_t {
+    static thread_local pid_t tid = gettid();
+    return tid;
+  }
+  auto ShouldCaptureStack() const -> bool {
+    static thread_local uint32_t skipped = 0;
+    if (++skipped < stack_sample_period_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    skipped = 0;
+    return true;
+  }
   auto GetCallStack(std::vector<void*>& callstack) -> void {
     constexpr size_t kMaxStackDepth = 16;
     std::array<void*, kMaxStackDepth> stack{};
@@ -110,24 +190,68 @@ class LockTracker {
                          std::unordered_set<pthread_t>& visited_threads,
                          std::vector<std::pair<void*, pthread_t>>& lock_chain)
       -> bool;
-  auto PrintLockInfo(const LockInfo& info) const -> void;
+  static auto PrintLockInfo(
+      const LockInfo& info,
+      const std::unordered_map<void*, LockInfo>& active_locks) -> void;
+  static auto PrintLockState(const LockSnapshot& snapshot) -> void;
   auto PrintCallStack(const std::vector<void*>& callstack) const -> void;
   mutable std::mutex mutex_;
   std::unordered_map<void*, LockInfo> active_locks_;
   std::unordered_map<pthread_t, ThreadInfo> thread_info_;
+  // Atomic so GetCounters can read them without the lock, e.g. from a
+  // signal handler. Writers still update them under mutex_.
+  std::atomic<size_t> acquisitions_ = 0;
+  std::atomic<size_t> contended_acquisitions_ = 0;
+  std::atomic<size_t> deadlocks_detected_ = 0;
+  std::atomic<uint64_t> total_wait_ns_ = 0;
+  std::atomic<uint32_t> stack_sample_period_ = 1;
+  // std::mutex never calls pthread_mutex_destroy, so the table is also
+  // capped: when full, the less-used half is evicted.
+  static constexpr size_t kMaxLockStats = 65536;
+  auto StatsFor(void* lock_addr) -> LockStats&;
+  std::unordered_map<void*, LockStats> lock_stats_;
+  std::unordered_map<pid_t, ThreadWaitStats> thread_wait_;
+  std::mutex report_mutex_;
+  LockSnapshot last_report_;
+  LockSnapshot checkpoint_;
 };
 static auto Instance() -> LockTracker& { return LockTracker::GetInstance(); }
+auto LockTracker::StatsFor(void* lock_addr) -> LockStats& {
+  auto it = lock_stats_.find(lock_addr);
+  if (it != lock_stats_.end()) {
+    return it->second;
+  }
+  if (lock_stats_.size() >= kMaxLockStats) {
+    std::vector<std::pair<size_t, void*>> usage;
+    usage.reserve(lock_stats_.size());
+    for (const auto& pair : lock_stats_) {
+      usage.emplace_back(
+          pair.second.acquisitions + pair.second.contended_acquisitions,
+          pair.first);
+    }
+    auto middle = usage.begin() + static_cast<ptrdiff_t>(usage.size() / 2);
+    std::ranges::nth_element(usage, middle);
+    for (auto evict = usage.begin(); evict != middle; ++evict) {
+      lock_stats_.erase(evict->second);
+    }
+  }
+  LockStats& stats = lock_stats_[lock_addr];
+  stats.lock_addr = lock_addr;
+  return stats;
+}
 auto LockTracker::DetectDeadlock(void* lock_addr, pthread_t thread_id) -> bool {
   std::unordered_set<pthread_t> visited_threads;
   std::vector<std::pair<void*, pthread_t>> lock_chain;
   bool found_deadlock =
       DetectDeadlockDFS(lock_addr, thread_id, visited_threads, lock_chain);
   if (found_deadlock) {
+    deadlocks_detected_.fetch_add(1, std::memory_order_relaxed);
+    ReportSection section;
     TRACKER_PRINT("\n=== Potential Deadlock Detected! ===\n");
     TRACKER_PRINT("Lock chain:\n");
     for (const auto& pair : lock_chain) {
       const auto& info = active_locks_[pair.first];
-      PrintLockInfo(info);
+      PrintLockInfo(info, active_locks_);
       TRACKER_PRINT("\n");
     }
   }
@@ -159,7 +283,9 @@ auto LockTracker::DetectDeadlockDFS(
   lock_chain.pop_back();
   return false;
 }
-auto LockTracker::PrintLockInfo(const LockInfo& info) const -> void {
+auto LockTracker::PrintLockInfo(
+    const LockInfo& info,
+    const std::unordered_map<void*, LockInfo>& active_locks) -> void {
   TRACKER_PRINT("Lock %p (Mutex) held by thread %lu\n", info.lock_addr,
                 info.owner_thread);
   TRACKER_PRINT("Acquired at:\n");
@@ -174,8 +300,8 @@ auto LockTracker::PrintLockInfo(const LockInfo& info) const -> void {
   if (!info.waiting_for.empty()) {
     TRACKER_PRINT("Waiting for locks:");
     for (void* waited_lock : info.waiting_for) {
-      auto it = active_locks_.find(waited_lock);
-      if (it != active_locks_.end()) {
+      auto it = active_locks.find(waited_lock);
+      if (it != active_locks.end()) {
         TRACKER_PRINT(" %p (held by thread %lu)", waited_lock,
                       it->second.owner_thread);
       } else {
@@ -185,21 +311,164 @@ auto LockTracker::PrintLockInfo(const LockInfo& info) const -> void {
     TRACKER_PRINT("\n");
   }
 }
-auto LockTracker::PrintStatus() const -> void {
+auto LockTracker::TakeSnapshot() const -> LockSnapshot {
   std::lock_guard<std::mutex> lock(mutex_);
+  LockSnapshot snapshot;
+  snapshot.active_locks = active_locks_;
+  snapshot.thread_info = thread_info_;
+  snapshot.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+  snapshot.contended_acquisitions =
+      contended_acquisitions_.load(std::memory_order_relaxed);
+  snapshot.deadlocks_detected =
+      deadlocks_detected_.load(std::memory_order_relaxed);
+  snapshot.total_wait_ns = total_wait_ns_.load(std::memory_order_relaxed);
+  snapshot.lock_stats = lock_stats_;
+  return snapshot;
+}
+auto LockTracker::PrintStatus() const -> void {
+  LockSnapshot snapshot = TakeSnapshot();
+  ReportSection section;
   TRACKER_PRINT("\n=== Lock Detector Status ===\n");
-  TRACKER_PRINT("Active locks: %zu\n", active_locks_.size());
-  TRACKER_PRINT("Active threads: %zu\n", thread_info_.size());
-  if (!active_locks_.empty()) {
+  PrintLockState(snapshot);
+  TRACKER_PRINT("\n===========================\n");
+}
+// Counters are reported as deltas since the previous incremental report;
+// the held/waiting state is always current.
+auto LockTracker::PrintIncrementalStatus() -> void {
+  std::lock_guard<std::mutex> report_lock(report_mutex_);
+  LockSnapshot snapshot = TakeSnapshot();
+  ReportSection section;
+  TRACKER_PRINT("\n=== Lock Detector Report (incremental) ===\n");
+  TRACKER_PRINT("Acquisitions since last report: %zu\n",
+                snapshot.acquisitions - last_report_.acquisitions);
+  TRACKER_PRINT("Contended acquisitions since last report: %zu\n",
+                snapshot.contended_acquisitions -
+                    last_report_.contended_acquisitions);
+  TRACKER_PRINT("Deadlocks detected since last report: %zu\n",
+                snapshot.deadlocks_detected - last_report_.deadlocks_detected);
+  PrintLockState(snapshot);
+  TRACKER_PRINT("\n===========================\n");
+  last_report_.acquisitions = snapshot.acquisitions;
+  last_report_.contended_acquisitions = snapshot.contended_acquisitions;
+  last_report_.deadlocks_detected = snapshot.deadlocks_detected;
+}
+// Most-waited-on locks first; ties broken by contended acquisitions.
+// Only the top `count` are copied out from under the lock, so a refresh
+// never copies the whole table while hooked lock calls wait.
+auto LockTracker::GetLockStats(size_t count) const -> std::vector<LockStats> {
+  std::vector<LockStats> result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  result.resize(std::min(count, lock_stats_.size()));
+  std::ranges::partial_sort_copy(
+      lock_stats_ | std::views::values, result,
+      [](const auto& lhs, const auto& rhs) {
+        if (lhs.wait_ns != rhs.wait_ns) {
+          return lhs.wait_ns > rhs.wait_ns;
+        }
+        return lhs.contended_acquisitions > rhs.contended_acquisitions;
+      });
+  return result;
+}
+// Threads that spent the most time blocked on tracked locks first.
+auto LockTracker::GetThreadWaitStats(size_t count) const
+    -> std::vector<ThreadWaitStats> {
+  std::vector<ThreadWaitStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(thread_wait_.size());
+    for (const auto& pair : thread_wait_) {
+      result.push_back(pair.second);
+    }
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.wait_ns > rhs.wait_ns;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+// Approximate heap held by the lock tables, including captured stacks.
+auto LockTracker::GetMetadataBytes() const -> size_t {
+  constexpr size_t kNodeOverhead = 2 * sizeof(void*);
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t bytes = 0;
+  for (const auto& pair : active_locks_) {
+    bytes += sizeof(pair) + kNodeOverhead +
+             pair.second.callstack.capacity() * sizeof(void*) +
+             pair.second.waiting_for.size() * (sizeof(void*) + kNodeOverhead);
+  }
+  for (const auto& pair : thread_info_) {
+    bytes += sizeof(pair) + kNodeOverhead +
+             (pair.second.held_locks.capacity() +
+              pair.second.waiting_locks.capacity()) *
+                 sizeof(void*);
+  }
+  bytes += lock_stats_.size() *
+           (sizeof(std::pair<void* const, LockStats>) + kNodeOverhead);
+  bytes += thread_wait_.size() *
+           (sizeof(std::pair<const pid_t, ThreadWaitStats>) + kNodeOverhead);
+  bytes += (active_locks_.bucket_count() + thread_info_.bucket_count() +
+            lock_stats_.bucket_count() + thread_wait_.bucket_count()) *
+           sizeof(void*);
+  return bytes;
+}
+auto LockTracker::PrintContention(size_t count) const -> void {
+  constexpr double kNsPerUs = 1000.0;
+  std::vector<LockStats> stats = GetLockStats(count);
+  ReportSection section;
+  TRACKER_PRINT("\n=== Top %zu Contended Locks ===\n", count);
+  for (size_t i = 0; i < stats.size(); ++i) {
+    TRACKER_PRINT(
+        "[%zu] Lock %p: %zu acquisitions, %zu contended, wait %.1f us total, "
+        "%.1f us max\n",
+        i, stats[i].lock_addr, stats[i].acquisitions,
+        stats[i].contended_acquisitions,
+        static_cast<double>(stats[i].wait_ns) / kNsPerUs,
+        static_cast<double>(stats[i].max_wait_ns) / kNsPerUs);
+  }
+  TRACKER_PRINT("===========================\n");
+}
+auto LockTracker::Checkpoint() -> void {
+  LockCounters counters = GetCounters();
+  std::lock_guard<std::mutex> report_lock(report_mutex_);
+  checkpoint_.acquisitions = counters.acquisitions;
+  checkpoint_.contended_acquisitions = counters.contended_acquisitions;
+  checkpoint_.deadlocks_detected = counters.deadlocks_detected;
+  checkpoint_.total_wait_ns = counters.total_wait_ns;
+}
+auto LockTracker::PrintDiff() -> void {
+  constexpr double kNsPerUs = 1000.0;
+  LockCounters counters = GetCounters();
+  std::lock_guard<std::mutex> report_lock(report_mutex_);
+  ReportSection section;
+  TRACKER_PRINT("\n=== Lock Detector Diff ===\n");
+  TRACKER_PRINT("Acquisitions since checkpoint: %zu\n",
+                counters.acquisitions - checkpoint_.acquisitions);
+  TRACKER_PRINT("Contended acquisitions since checkpoint: %zu\n",
+                counters.contended_acquisitions -
+                    checkpoint_.contended_acquisitions);
+  TRACKER_PRINT("Deadlocks detected since checkpoint: %zu\n",
+                counters.deadlocks_detected - checkpoint_.deadlocks_detected);
+  TRACKER_PRINT(
+      "Lock wait since checkpoint: %.1f us\n",
+      static_cast<double>(counters.total_wait_ns - checkpoint_.total_wait_ns) /
+          kNsPerUs);
+  TRACKER_PRINT("===========================\n");
+}
+auto LockTracker::PrintLockState(const LockSnapshot& snapshot) -> void {
+  TRACKER_PRINT("Active locks: %zu\n", snapshot.active_locks.size());
+  TRACKER_PRINT("Active threads: %zu\n", snapshot.thread_info.size());
+  if (!snapshot.active_locks.empty()) {
     TRACKER_PRINT("\nDetailed lock information:\n");
-    for (const auto& pair : active_locks_) {
+    for (const auto& pair : snapshot.active_locks) {
       TRACKER_PRINT("\n");
-      PrintLockInfo(pair.second);
+      PrintLockInfo(pair.second, snapshot.active_locks);
     }
   }
-  if (!thread_info_.empty()) {
+  if (!snapshot.thread_info.empty()) {
     TRACKER_PRINT("\nThread Information:\n");
-    for (const auto& pair : thread_info_) {
+    for (const auto& pair : snapshot.thread_info) {
       TRACKER_PRINT("\nThread %lu:\n", pair.first);
       TRACKER_PRINT("  Held locks:");
       for (void* held_lock : pair.second.held_locks) {
@@ -207,8 +476,8 @@ auto LockTracker::PrintStatus() const -> void {
       }
       TRACKER_PRINT("\n  Waiting for locks:");
       for (void* waited_lock : pair.second.waiting_locks) {
-        auto it = active_locks_.find(waited_lock);
-        if (it != active_locks_.end()) {
+        auto it = snapshot.active_locks.find(waited_lock);
+        if (it != snapshot.active_locks.end()) {
           TRACKER_PRINT(" %p (held by thread %lu)", waited_lock,
                         it->second.owner_thread);
         } else {
@@ -218,7 +487,6 @@ auto LockTracker::PrintStatus() const -> void {
       TRACKER_PRINT("\n");
     }
   }
-  TRACKER_PRINT("\n===========================\n");
 }
 auto LockTracker::PrintCallStack(const std::vector<void*>& callstack) const
     -> void {
@@ -236,25 +504,45 @@ using PthreadMutexFunc = int (*)(pthread_mutex_t*);
 static PthreadMutexFunc g_orig_mutex_lock = nullptr;
 static PthreadMutexFunc g_orig_mutex_unlock = nullptr;
 static PthreadMutexFunc g_orig_mutex_trylock = nullptr;
+static PthreadMutexFunc g_orig_mutex_destroy = nullptr;
 static auto HookedPthreadMutexLock(pthread_mutex_t* mutex) -> int {
+  tracker::HookScope scope(tracker::HookKind::kMutexLock);
   tracker::Instance().RecordLockAcquire(mutex);
+  auto wait_start = std::chrono::steady_clock::now();
+  uint64_t wait_start_cycles = tracker::ReadCycles();
   int result = g_orig_mutex_lock(mutex);
+  // the wait is the application's time, not the detector's
+  scope.Exclude(tracker::ReadCycles() - wait_start_cycles);
   if (result == 0) {
-    tracker::Instance().RecordLockAcquired(mutex);
+    auto wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - wait_start);
+    tracker::Instance().RecordLockAcquired(
+        mutex, static_cast<uint64_t>(wait_ns.count()));
   }
   return result;
 }
 static auto HookedPthreadMutexUnlock(pthread_mutex_t* mutex) -> int {
-  tracker::Instance().RecordLockRelease(mutex);
+  {
+    tracker::HookScope scope(tracker::HookKind::kMutexUnlock);
+    tracker::Instance().RecordLockRelease(mutex);
+  }
   return g_orig_mutex_unlock(mutex);
 }
 static auto HookedPthreadMutexTrylock(pthread_mutex_t* mutex) -> int {
   int result = g_orig_mutex_trylock(mutex);
   if (result == 0) {
-    tracker::Instance().RecordLockAcquired(mutex);
+    tracker::HookScope scope(tracker::HookKind::kMutexTrylock);
+    tracker::Instance().RecordLockAcquired(mutex, 0);
   }
   return result;
 }
+static auto HookedPthreadMutexDestroy(pthread_mutex_t* mutex) -> int {
+  {
+    tracker::HookScope scope(tracker::HookKind::kMutexDestroy);
+    tracker::Instance().RecordLockDestroy(mutex);
+  }
+  return g_orig_mutex_destroy(mutex);
+}
 class LockHook {
  public:
   explicit LockHook(std::string lib_path) : lib_path_(std::move(lib_path)) {}
@@ -294,18 +582,38 @@ auto LockHook::Start() -> void {
     } else {
       g_orig_mutex_trylock = reinterpret_cast<PthreadMutexFunc>(orig_trylock);
     }
+    // Not every module destroys its mutexes; nothing to report if absent.
+    void* orig_destroy = nullptr;
+    if (hook_->ReplaceFunction(
+            "pthread_mutex_destroy",
+            reinterpret_cast<void*>(&HookedPthreadMutexDestroy),
+            &orig_destroy) == PltHook::ErrorCode::kSuccess) {
+      g_orig_mutex_destroy = reinterpret_cast<PthreadMutexFunc>(orig_destroy);
+    }
   } catch (const std::exception& e) {
     TRACKER_ERROR("Error starting lock tracking: %s", e.what());
   }
 }
 class LockDetectImpl {
  public:
-  LockDetectImpl() = default;
+  // The tracker is built along with the detector, so lock-free readers such
+  // as the signal dump never run its initialization.
+  LockDetectImpl() { tracker::Instance(); }
   ~LockDetectImpl() = default;
   auto Register(const std::string& lib_name) -> void;
   auto RegisterMain() -> void;
   auto Start() -> void;
   auto Detect() -> void;
+  auto DetectIncremental() -> void;
+  auto GetCounters() const -> LockCounters;
+  auto GetLockStats(size_t count) const -> std::vector<LockStats>;
+  auto GetThreadWaitStats(size_t count) const -> std::vector<ThreadWaitStats>;
+  auto GetMetadataBytes() const -> size_t;
+  auto SetStackSamplePeriod(uint32_t period) -> void;
+  auto GetStackSamplePeriod() const -> uint32_t;
+  auto PrintContention(size_t count) -> void;
+  auto Checkpoint() -> void;
+  auto PrintDiff() -> void;
 
  private:
   std::vector<std::unique_ptr<LockHook>> hooks_;
@@ -317,11 +625,41 @@ auto LockDetectImpl::RegisterMain() -> void {
   hooks_.emplace_back(std::make_unique<LockHook>(std::string()));
 }
 auto LockDetectImpl::Start() -> void {
+  tracker::Instance();
+  tracker::OverheadAccounting::Instance().Start();
   for (auto& hook : hooks_) {
     hook->Start();
   }
 }
 auto LockDetectImpl::Detect() -> void { tracker::Instance().PrintStatus(); }
+auto LockDetectImpl::GetCounters() const -> LockCounters {
+  return tracker::Instance().GetCounters();
+}
+auto LockDetectImpl::GetLockStats(size_t count) const
+    -> std::vector<LockStats> {
+  return tracker::Instance().GetLockStats(count);
+}
+auto LockDetectImpl::GetThreadWaitStats(size_t count) const
+    -> std::vector<ThreadWaitStats> {
+  return tracker::Instance().GetThreadWaitStats(count);
+}
+auto LockDetectImpl::GetMetadataBytes() const -> size_t {
+  return tracker::Instance().GetMetadataBytes();
+}
+auto LockDetectImpl::SetStackSamplePeriod(uint32_t period) -> void {
+  tracker::Instance().SetStackSamplePeriod(period);
+}
+auto LockDetectImpl::GetStackSamplePeriod() const -> uint32_t {
+  return tracker::Instance().GetStackSamplePeriod();
+}
+auto LockDetectImpl::PrintContention(size_t count) -> void {
+  tracker::Instance().PrintContention(count);
+}
+auto LockDetectImpl::Checkpoint() -> void { tracker::Instance().Checkpoint(); }
+auto LockDetectImpl::PrintDiff() -> void { tracker::Instance().PrintDiff(); }
+auto LockDetectImpl::DetectIncremental() -> void {
+  tracker::Instance().PrintIncrementalStatus();
+}
 LockDetect::LockDetect() : impl_(std::make_unique<LockDetectImpl>()) {}
 LockDetect::~LockDetect() = default;
 auto LockDetect::Register(const std::string& lib_name) -> void {
@@ -330,3 +668,28 @@ auto LockDetect::Register(const std::string& lib_name) -> void {
 auto LockDetect::RegisterMain() -> void { impl_->RegisterMain(); }
 auto LockDetect::Start() -> void { impl_->Start(); }
 auto LockDetect::Detect() -> void { impl_->Detect(); }
+auto LockDetect::DetectIncremental() -> void { impl_->DetectIncremental(); }
+auto LockDetect::GetCounters() const -> LockCounters {
+  return impl_->GetCounters();
+}
+auto LockDetect::GetLockStats(size_t count) const -> std::vector<LockStats> {
+  return impl_->GetLockStats(count);
+}
+auto LockDetect::GetThreadWaitStats(size_t count) const
+    -> std::vector<ThreadWaitStats> {
+  return impl_->GetThreadWaitStats(count);
+}
+auto LockDetect::GetMetadataBytes() const -> size_t {
+  return impl_->GetMetadataBytes();
+}
+auto LockDetect::SetStackSamplePeriod(uint32_t period) -> void {
+  impl_->SetStackSamplePeriod(period);
+}
+auto LockDetect::GetStackSamplePeriod() const -> uint32_t {
+  return impl_->GetStackSamplePeriod();
+}
+auto LockDetect::PrintContention(size_t count) -> void {
+  impl_->PrintContention(count);
+}
+auto LockDetect::Checkpoint() -> void { impl_->Checkpoint(); }
+auto LockDetect::PrintDiff() -> void { impl_->PrintDiff(); }
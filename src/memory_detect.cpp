@@ -1,10 +1,20 @@
 #include "memory_detect.h"
 
+#include <dirent.h>
 #include <dlfcn.h>
+#include <elf.h>
+#include <link.h>
 #include <execinfo.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -13,6 +23,7 @@
 #include <vector>
 
 #include "output_control.h"
+#include "overhead.h"
 #include "plthook.h"
 #define TRACKER_DEBUG(...) ((void)0)
 namespace tracker {
@@ -21,6 +32,19 @@ struct AllocationInfo {
   size_t size;
   std::array<void*, kCallStackNum> callstack;
   size_t callstack_size;
+  // First frame outside the detector; the key into the live site table.
+  void* site;
+};
+// Totals and outstanding bytes per site at one point in time, the base of
+// incremental reports and diffs. Copying the site table costs O(sites), not
+// O(live allocations), so taking one every interval barely holds up
+// allocating threads.
+struct MemorySnapshot {
+  size_t total_allocated = 0;
+  size_t total_freed = 0;
+  size_t active_allocations = 0;
+  size_t active_bytes = 0;
+  std::unordered_map<void*, AllocationSite> sites;
 };
 class MemoryTracker {
  public:
@@ -31,44 +55,190 @@ class MemoryTracker {
   auto RecordAllocation(void* ptr, size_t size) -> void;
   auto RecordDeallocation(void* ptr) -> void;
   auto UpdateAllocationSize(void* ptr, size_t new_size) -> void;
+  auto TakeSnapshot() const -> MemorySnapshot;
   auto PrintStatus() const -> void;
+  auto PrintIncrementalStatus() -> void;
+  auto Checkpoint() -> void;
+  auto PrintDiff() -> void;
+  auto GetTopSites(size_t count) const -> std::vector<AllocationSite>;
+  // Outstanding allocations with no stack to attribute them to.
+  auto GetUnsampled() const -> AllocationSite;
+  auto PrintTopSites(size_t count) const -> void;
   auto HasLeaks() -> bool;
   auto GetTotalAllocated() const -> size_t;
   auto GetActiveAllocations() const -> size_t;
+  auto GetCounters() const -> MemoryCounters;
+  auto GetSizeHistogram() const -> SizeHistogram;
+  auto GetMetadataBytes() const -> size_t;
+  // open_memstream hands out its buffer only as of the last flush; the
+  // final one is recorded when the stream is closed. Only fclose from a
+  // hooked module is seen: a stream opened in one and closed from an
+  // unhooked module keeps its entry until the FILE* is reused, and its
+  // buffer is never recorded.
+  auto AddMemStream(FILE* stream, char** buffer, size_t* size) -> void;
+  auto TakeMemStream(FILE* stream, char**& buffer, size_t*& size) -> bool;
+  auto SetSamplePeriod(uint32_t period) -> void {
+    sample_period_.store(std::max<uint32_t>(period, 1),
+                         std::memory_order_relaxed);
+  }
+  auto GetSamplePeriod() const -> uint32_t {
+    return sample_period_.load(std::memory_order_relaxed);
+  }
   MemoryTracker(const MemoryTracker&) = delete;
   auto operator=(const MemoryTracker&) -> MemoryTracker& = delete;
 
  private:
-  MemoryTracker() = default;
+  MemoryTracker();
+  // Every allocation is tracked; only one in sample_period_ per thread pays
+  // for a stack unwind.
+  auto ShouldCaptureStack() const -> bool {
+    static thread_local uint32_t skipped = 0;
+    if (++skipped < sample_period_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    skipped = 0;
+    return true;
+  }
+  auto SiteOf(const AllocationInfo& info) const -> void*;
+  auto AddToSite(void* site, size_t size) -> void;
+  auto RemoveFromSite(void* site, size_t size) -> void;
+  auto PrintAllocation(void* ptr, const AllocationInfo& info) const -> void;
+  auto PrintChangesSince(const char* title, const char* label,
+                         const MemorySnapshot& base) const -> MemorySnapshot;
   mutable std::mutex mutex_;
   std::unordered_map<void*, AllocationInfo> allocations_;
-  size_t total_allocated_ = 0;
-  size_t total_freed_ = 0;
-  size_t active_allocations_ = 0;
+  // Outstanding bytes per allocation site, kept up to date under mutex_ so
+  // GetTopSites copies one entry per site instead of walking every
+  // allocation.
+  std::unordered_map<void*, AllocationSite> sites_;
+  // Address range of this library, for telling detector frames apart
+  // without dladdr on the hot path.
+  uintptr_t self_begin_ = 0;
+  uintptr_t self_end_ = 0;
+  // Atomic so GetCounters can read them without the lock, e.g. from a
+  // signal handler. Writers still update them under mutex_.
+  std::atomic<size_t> total_allocated_ = 0;
+  std::atomic<size_t> total_freed_ = 0;
+  std::atomic<size_t> active_allocations_ = 0;
+  std::atomic<size_t> active_bytes_ = 0;
+  std::atomic<size_t> allocation_count_ = 0;
+  std::atomic<size_t> free_count_ = 0;
+  std::array<std::atomic<size_t>, kSizeClassCount> size_classes_{};
+  std::atomic<size_t> size_class_sum_ = 0;
+  std::atomic<uint32_t> sample_period_ = 1;
+  struct MemStream {
+    char** buffer;
+    size_t* size;
+  };
+  std::mutex memstream_mutex_;
+  std::unordered_map<FILE*, MemStream> memstreams_;
+  // Lets every other fclose skip the lock.
+  std::atomic<size_t> memstream_count_ = 0;
+  std::mutex report_mutex_;
+  MemorySnapshot last_report_;
+  MemorySnapshot checkpoint_;
 };
+auto Instance() -> MemoryTracker&;
+MemoryTracker::MemoryTracker() {
+  struct Range {
+    uintptr_t self;
+    uintptr_t begin;
+    uintptr_t end;
+  } range{reinterpret_cast<uintptr_t>(&Instance), 0, 0};
+  dl_iterate_phdr(
+      [](struct dl_phdr_info* info, size_t, void* data) -> int {
+        auto* found = static_cast<Range*>(data);
+        uintptr_t begin = UINTPTR_MAX;
+        uintptr_t end = 0;
+        for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+          const auto& phdr = info->dlpi_phdr[i];
+          if (phdr.p_type != PT_LOAD) {
+            continue;
+          }
+          begin = std::min<uintptr_t>(begin, info->dlpi_addr + phdr.p_vaddr);
+          end = std::max<uintptr_t>(
+              end, info->dlpi_addr + phdr.p_vaddr + phdr.p_memsz);
+        }
+        if (found->self < begin || found->self >= end) {
+          return 0;
+        }
+        found->begin = begin;
+        found->end = end;
+        return 1;
+      },
+      &range);
+  self_begin_ = range.begin;
+  self_end_ = range.end;
+}
+auto MemoryTracker::SiteOf(const AllocationInfo& info) const -> void* {
+  for (size_t i = 0; i < info.callstack_size; ++i) {
+    auto frame = reinterpret_cast<uintptr_t>(info.callstack[i]);
+    if (frame < self_begin_ || frame >= self_end_) {
+      return info.callstack[i];
+    }
+  }
+  return nullptr;
+}
+auto MemoryTracker::AddToSite(void* site, size_t size) -> void {
+  auto& entry = sites_[site];
+  entry.site = site;
+  entry.bytes += size;
+  entry.count++;
+}
+auto MemoryTracker::RemoveFromSite(void* site, size_t size) -> void {
+  auto it = sites_.find(site);
+  if (it == sites_.end()) {
+    return;
+  }
+  // Emptied sites stay: allocation sites are few, and erasing would cost a
+  // node free and reallocation on every alloc/free pair.
+  it->second.bytes -= std::min(it->second.bytes, size);
+  it->second.count -= std::min<size_t>(it->second.count, 1);
+}
 auto MemoryTracker::RecordAllocation(void* ptr, size_t size) -> void {
   if (ptr == nullptr) {
     return;
   }
-  std::lock_guard<std::mutex> lock(mutex_);
   AllocationInfo info;
   info.size = size;
-  info.callstack_size =
-      static_cast<size_t>(backtrace(info.callstack.data(), kCallStackNum));
+  info.callstack_size = 0;
+  if (ShouldCaptureStack()) {
+    PhaseScope unwind(OverheadPhase::kUnwind);
+    info.callstack_size =
+        static_cast<size_t>(backtrace(info.callstack.data(), kCallStackNum));
+  }
   TRACKER_DEBUG("RecordAllocation: %p, size: %zu\n", ptr, size);
+  constexpr size_t kSmallestClassBits = 4;
+  size_t size_class =
+      size <= (size_t{1} << kSmallestClassBits)
+          ? 0
+          : std::min<size_t>(std::bit_width(size - 1) - kSmallestClassBits,
+                             kSizeClassCount - 1);
+  size_classes_[size_class].fetch_add(1, std::memory_order_relaxed);
+  size_class_sum_.fetch_add(size, std::memory_order_relaxed);
+  info.site = SiteOf(info);
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
   allocations_[ptr] = info;
-  total_allocated_ += size;
-  active_allocations_++;
+  AddToSite(info.site, size);
+  total_allocated_.fetch_add(size, std::memory_order_relaxed);
+  active_bytes_.fetch_add(size, std::memory_order_relaxed);
+  active_allocations_.fetch_add(1, std::memory_order_relaxed);
+  allocation_count_.fetch_add(1, std::memory_order_relaxed);
 }
 auto MemoryTracker::RecordDeallocation(void* ptr) -> void {
   if (ptr == nullptr) {
     return;
   }
+  PhaseScope table(OverheadPhase::kTable);
   std::lock_guard<std::mutex> lock(mutex_);
   auto it = allocations_.find(ptr);
   if (it != allocations_.end()) {
-    total_freed_ += it->second.size;
-    active_allocations_--;
+    total_freed_.fetch_add(it->second.size, std::memory_order_relaxed);
+    active_bytes_.fetch_sub(it->second.size, std::memory_order_relaxed);
+    active_allocations_.fetch_sub(1, std::memory_order_relaxed);
+    free_count_.fetch_add(1, std::memory_order_relaxed);
+    RemoveFromSite(it->second.site, it->second.size);
     allocations_.erase(it);
   }
 }
@@ -76,143 +246,389 @@ auto MemoryTracker::UpdateAllocationSize(void* ptr, size_t new_size) -> void {
   if (ptr == nullptr) {
     return;
   }
+  PhaseScope table(OverheadPhase::kTable);
   std::lock_guard<std::mutex> lock(mutex_);
   auto it = allocations_.find(ptr);
   if (it != allocations_.end()) {
-    total_allocated_ = total_allocated_ - it->second.size + new_size;
+    total_allocated_.fetch_add(new_size, std::memory_order_relaxed);
+    total_allocated_.fetch_sub(it->second.size, std::memory_order_relaxed);
+    // Add before subtracting so a concurrent reader never sees it wrap.
+    active_bytes_.fetch_add(new_size, std::memory_order_relaxed);
+    active_bytes_.fetch_sub(it->second.size, std::memory_order_relaxed);
+    RemoveFromSite(it->second.site, it->second.size);
     it->second.size = new_size;
-    it->second.callstack_size = static_cast<size_t>(
-        backtrace(it->second.callstack.data(), kCallStackNum));
+    if (ShouldCaptureStack()) {
+      PhaseScope unwind(OverheadPhase::kUnwind);
+      it->second.callstack_size = static_cast<size_t>(
+          backtrace(it->second.callstack.data(), kCallStackNum));
+      it->second.site = SiteOf(it->second);
+    }
+    AddToSite(it->second.site, new_size);
   }
 }
-// NOLINTNEXTLINE(readability-function-cognitive-complexity)
-auto MemoryTracker::PrintStatus() const -> void {
+auto MemoryTracker::AddMemStream(FILE* stream, char** buffer, size_t* size)
+    -> void {
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(memstream_mutex_);
+  memstreams_[stream] = {buffer, size};
+  memstream_count_.store(memstreams_.size(), std::memory_order_relaxed);
+}
+auto MemoryTracker::TakeMemStream(FILE* stream, char**& buffer, size_t*& size)
+    -> bool {
+  if (memstream_count_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  {
+    PhaseScope table(OverheadPhase::kTable);
+    std::lock_guard<std::mutex> lock(memstream_mutex_);
+    auto it = memstreams_.find(stream);
+    if (it == memstreams_.end()) {
+      return false;
+    }
+    buffer = it->second.buffer;
+    size = it->second.size;
+    memstreams_.erase(it);
+    memstream_count_.store(memstreams_.size(), std::memory_order_relaxed);
+  }
+  // A stale entry whose address now belongs to a file stream: a memstream
+  // has no descriptor.
+  int saved_errno = errno;
+  bool memstream = fileno(stream) < 0;
+  errno = saved_errno;
+  return memstream;
+}
+auto MemoryTracker::TakeSnapshot() const -> MemorySnapshot {
+  MemorySnapshot snapshot;
   std::lock_guard<std::mutex> lock(mutex_);
+  snapshot.total_allocated = total_allocated_.load(std::memory_order_relaxed);
+  snapshot.total_freed = total_freed_.load(std::memory_order_relaxed);
+  snapshot.active_allocations =
+      active_allocations_.load(std::memory_order_relaxed);
+  snapshot.active_bytes = active_bytes_.load(std::memory_order_relaxed);
+  snapshot.sites = sites_;
+  return snapshot;
+}
+// Symbol and module of a call site, "??" where unknown.
+static auto SymbolizeSite(void* site, const char*& symbol, const char*& module)
+    -> void {
+  symbol = "??";
+  module = "??";
+  Dl_info dlinfo;
+  if (site != nullptr && dladdr(site, &dlinfo) != 0) {
+    symbol = dlinfo.dli_sname != nullptr ? dlinfo.dli_sname : symbol;
+    module = dlinfo.dli_fname != nullptr ? dlinfo.dli_fname : module;
+  }
+}
+// Lists every outstanding allocation with its symbolized stack; meant for
+// the final report, not for the periodic path.
+auto MemoryTracker::PrintStatus() const -> void {
+  std::vector<std::pair<void*, AllocationInfo>> allocations;
+  size_t total_allocated = 0;
+  size_t total_freed = 0;
+  size_t active_allocations = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_allocated = total_allocated_.load(std::memory_order_relaxed);
+    total_freed = total_freed_.load(std::memory_order_relaxed);
+    active_allocations = active_allocations_.load(std::memory_order_relaxed);
+    allocations.assign(allocations_.begin(), allocations_.end());
+  }
+  ReportSection section;
   auto& output = tracker::OutputControl::Instance();
   TRACKER_PRINT("\n\n=== Memory Tracker Status ===\n");
-  TRACKER_PRINT("Total allocated: %zu bytes\n", total_allocated_);
-  TRACKER_PRINT("Total freed: %zu bytes\n", total_freed_);
-  TRACKER_PRINT("Active allocations: %zu\n", active_allocations_);
+  TRACKER_PRINT("Total allocated: %zu bytes\n", total_allocated);
+  TRACKER_PRINT("Total freed: %zu bytes\n", total_freed);
+  TRACKER_PRINT("Active allocations: %zu\n", active_allocations);
   TRACKER_PRINT("Potential leaks: ");
   output.PrintColored(
-      allocations_.empty() ? tracker::Color::kGreen : tracker::Color::kBoldRed,
-      tracker::Color::kReset, "%zu", allocations_.size());
+      allocations.empty() ? tracker::Color::kGreen : tracker::Color::kBoldRed,
+      tracker::Color::kReset, "%zu", allocations.size());
   TRACKER_PRINT("\n");
-  if (!allocations_.empty()) {
+  if (!allocations.empty()) {
     TRACKER_PRINT("\n");
     output.PrintColored(tracker::Color::kBoldYellow, tracker::Color::kReset,
                         "Detailed leak information:");
     TRACKER_PRINT("\n");
-    for (const auto& pair : allocations_) {
-      const auto& info = pair.second;
-      TRACKER_PRINT("\n");
-      output.PrintColored(tracker::Color::kBoldRed, tracker::Color::kReset,
-                          "Leak at %p (size: %zu bytes)", pair.first,
-                          info.size);
-      TRACKER_PRINT("\n");
-      char** symbols = backtrace_symbols(info.callstack.data(),
-                                         static_cast<int>(info.callstack_size));
-      if (symbols != nullptr) {
-        TRACKER_PRINT("Callstack:\n");
-        size_t frame_index = 0;
-        for (size_t i = 0; i < info.callstack_size; ++i) {
-          void* abs_addr = info.callstack[i];
-          Dl_info dlinfo;
-          if (dladdr(abs_addr, &dlinfo) != 0) {
-            bool is_detector_internal = false;
-            if (dlinfo.dli_fname != nullptr) {
-              if (strstr(dlinfo.dli_fname, "libnv_detector") != nullptr) {
-                is_detector_internal = true;
-              }
-            }
-            if (is_detector_internal) {
-              continue;
-            }
-            void* rel_addr = reinterpret_cast<void*>(
-                reinterpret_cast<char*>(abs_addr) -
-                reinterpret_cast<char*>(dlinfo.dli_fbase));
-            TRACKER_PRINT("  ");
-            if (frame_index == 0) {
-              output.PrintColored(tracker::Color::kBoldCyan,
-                                  tracker::Color::kReset,
-                                  "[%zu] Absolute: %p, Relative: %p",
-                                  frame_index, abs_addr, rel_addr);
-            } else {
-              TRACKER_PRINT("[%zu] Absolute: %p, Relative: %p", frame_index,
+    for (const auto& pair : allocations) {
+      PrintAllocation(pair.first, pair.second);
+    }
+  }
+  TRACKER_PRINT("\n===========================\n");
+}
+// Reports only what changed since the previous incremental report: byte
+// deltas and the sites whose outstanding bytes grew since then.
+auto MemoryTracker::PrintIncrementalStatus() -> void {
+  std::lock_guard<std::mutex> report_lock(report_mutex_);
+  last_report_ =
+      PrintChangesSince("Memory Tracker Report (incremental)", "last report",
+                        last_report_);
+}
+auto MemoryTracker::Checkpoint() -> void {
+  std::lock_guard<std::mutex> report_lock(report_mutex_);
+  checkpoint_ = TakeSnapshot();
+}
+auto MemoryTracker::PrintDiff() -> void {
+  std::lock_guard<std::mutex> report_lock(report_mutex_);
+  PrintChangesSince("Memory Tracker Diff", "checkpoint", checkpoint_);
+}
+// Prints the deltas between base and now, listing at most
+// kMaxGrownSites sites, and returns the new snapshot as the next base.
+auto MemoryTracker::PrintChangesSince(const char* title, const char* label,
+                                      const MemorySnapshot& base) const
+    -> MemorySnapshot {
+  constexpr size_t kMaxGrownSites = 10;
+  struct SiteGrowth {
+    void* site;
+    size_t bytes;
+    size_t count;
+  };
+  MemorySnapshot snapshot = TakeSnapshot();
+  std::vector<SiteGrowth> grown;
+  size_t unsampled_growth = 0;
+  for (const auto& [site, stats] : snapshot.sites) {
+    auto it = base.sites.find(site);
+    size_t base_bytes = it != base.sites.end() ? it->second.bytes : 0;
+    size_t base_count = it != base.sites.end() ? it->second.count : 0;
+    if (stats.bytes <= base_bytes) {
+      continue;
+    }
+    if (site == nullptr) {
+      unsampled_growth = stats.bytes - base_bytes;
+    } else {
+      grown.push_back({site, stats.bytes - base_bytes,
+                       stats.count - std::min(stats.count, base_count)});
+    }
+  }
+  size_t listed = std::min(grown.size(), kMaxGrownSites);
+  auto middle = grown.begin() + static_cast<ptrdiff_t>(listed);
+  std::partial_sort(grown.begin(), middle, grown.end(),
+                    [](const auto& lhs, const auto& rhs) {
+                      return lhs.bytes > rhs.bytes;
+                    });
+  ReportSection section;
+  auto& output = tracker::OutputControl::Instance();
+  TRACKER_PRINT("\n\n=== %s ===\n", title);
+  TRACKER_PRINT("Allocated since %s: %zu bytes\n", label,
+                snapshot.total_allocated - base.total_allocated);
+  TRACKER_PRINT("Freed since %s: %zu bytes\n", label,
+                snapshot.total_freed - base.total_freed);
+  TRACKER_PRINT("Active allocations: %zu (%zu bytes)\n",
+                snapshot.active_allocations, snapshot.active_bytes);
+  TRACKER_PRINT("Sites grown since %s: ", label);
+  output.PrintColored(grown.empty() ? tracker::Color::kGreen
+                                    : tracker::Color::kBoldRed,
+                      tracker::Color::kReset, "%zu", grown.size());
+  TRACKER_PRINT("\n");
+  for (size_t i = 0; i < listed; ++i) {
+    const char* symbol = nullptr;
+    const char* module = nullptr;
+    SymbolizeSite(grown[i].site, symbol, module);
+    TRACKER_PRINT("[%zu] +%zu bytes, +%zu allocations at %p %s (%s)\n", i,
+                  grown[i].bytes, grown[i].count, grown[i].site, symbol,
+                  module);
+  }
+  if (grown.size() > listed) {
+    TRACKER_PRINT("... and %zu more\n", grown.size() - listed);
+  }
+  if (unsampled_growth != 0) {
+    TRACKER_PRINT("Unsampled (no stack captured): +%zu bytes\n",
+                  unsampled_growth);
+  }
+  TRACKER_PRINT("===========================\n");
+  return snapshot;
+}
+// Outstanding allocations grouped by the first frame outside the detector.
+auto MemoryTracker::GetTopSites(size_t count) const
+    -> std::vector<AllocationSite> {
+  std::vector<AllocationSite> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.reserve(sites_.size());
+    for (const auto& pair : sites_) {
+      // Unsampled allocations share the null key; they are not a site.
+      if (pair.first != nullptr && pair.second.count != 0) {
+        result.push_back(pair.second);
+      }
+    }
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.bytes > rhs.bytes;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto MemoryTracker::GetUnsampled() const -> AllocationSite {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sites_.find(nullptr);
+  return it != sites_.end() ? it->second : AllocationSite{};
+}
+auto MemoryTracker::PrintTopSites(size_t count) const -> void {
+  std::vector<AllocationSite> sites = GetTopSites(count);
+  AllocationSite unsampled = GetUnsampled();
+  ReportSection section;
+  TRACKER_PRINT("\n=== Top %zu Allocation Sites ===\n", count);
+  for (size_t i = 0; i < sites.size(); ++i) {
+    const char* symbol = nullptr;
+    const char* module = nullptr;
+    SymbolizeSite(sites[i].site, symbol, module);
+    TRACKER_PRINT("[%zu] %zu bytes in %zu allocations at %p %s (%s)\n", i,
+                  sites[i].bytes, sites[i].count, sites[i].site, symbol,
+                  module);
+  }
+  if (unsampled.count != 0) {
+    TRACKER_PRINT("Unsampled (no stack captured): %zu bytes in %zu "
+                  "allocations\n",
+                  unsampled.bytes, unsampled.count);
+  }
+  TRACKER_PRINT("===========================\n");
+}
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto MemoryTracker::PrintAllocation(void* ptr, const AllocationInfo& info) const
+    -> void {
+  auto& output = tracker::OutputControl::Instance();
+  TRACKER_PRINT("\n");
+  output.PrintColored(tracker::Color::kBoldRed, tracker::Color::kReset,
+                      "Leak at %p (size: %zu bytes)", ptr, info.size);
+  TRACKER_PRINT("\n");
+  if (info.callstack_size == 0) {
+    TRACKER_PRINT("Callstack: not sampled\n");
+    return;
+  }
+  char** symbols = backtrace_symbols(info.callstack.data(),
+                                     static_cast<int>(info.callstack_size));
+  if (symbols == nullptr) {
+    return;
+  }
+  TRACKER_PRINT("Callstack:\n");
+  size_t frame_index = 0;
+  for (size_t i = 0; i < info.callstack_size; ++i) {
+    void* abs_addr = info.callstack[i];
+    Dl_info dlinfo;
+    if (dladdr(abs_addr, &dlinfo) != 0) {
+      bool is_detector_internal = false;
+      if (dlinfo.dli_fname != nullptr) {
+        if (strstr(dlinfo.dli_fname, "libnv_detector") != nullptr) {
+          is_detector_internal = true;
+        }
+      }
+      if (is_detector_internal) {
+        continue;
+      }
+      void* rel_addr =
+          reinterpret_cast<void*>(reinterpret_cast<char*>(abs_addr) -
+                                  reinterpret_cast<char*>(dlinfo.dli_fbase));
+      TRACKER_PRINT("  ");
+      if (frame_index == 0) {
+        output.PrintColored(tracker::Color::kBoldCyan, tracker::Color::kReset,
+                            "[%zu] Absolute: %p, Relative: %p", frame_index,
                             abs_addr, rel_addr);
-            }
-            TRACKER_PRINT("\n");
-            TRACKER_PRINT("      Module: %s\n", dlinfo.dli_fname);
-            constexpr size_t kCmdBufferSize = 256;
-            std::array<char, kCmdBufferSize> cmd{};
-            snprintf(cmd.data(), cmd.size(), "addr2line -e \"%s\" -f -C -p %p",
-                     dlinfo.dli_fname, rel_addr);
-            FILE* pipe = popen(cmd.data(), "r");
-            if (pipe != nullptr) {
-              constexpr size_t kLineBufferSize = 256;
-              std::array<char, kLineBufferSize> line{};
-              // NOLINTNEXTLINE(clang-analyzer-unix.BlockInCriticalSection)
-              if (fgets(line.data(), line.size(), pipe) != nullptr) {
-                TRACKER_PRINT("      ");
-                if (frame_index == 0) {
-                  output.PrintColored(tracker::Color::kBoldCyan,
-                                      tracker::Color::kReset, "Source: %s",
-                                      line.data());
-                } else {
-                  TRACKER_PRINT("Source: %s", line.data());
-                }
-              }
-              pclose(pipe);
-            }
-            frame_index++;
+      } else {
+        TRACKER_PRINT("[%zu] Absolute: %p, Relative: %p", frame_index,
+                      abs_addr, rel_addr);
+      }
+      TRACKER_PRINT("\n");
+      TRACKER_PRINT("      Module: %s\n", dlinfo.dli_fname);
+      constexpr size_t kCmdBufferSize = 256;
+      std::array<char, kCmdBufferSize> cmd{};
+      snprintf(cmd.data(), cmd.size(), "addr2line -e \"%s\" -f -C -p %p",
+               dlinfo.dli_fname, rel_addr);
+      FILE* pipe = popen(cmd.data(), "r");
+      if (pipe != nullptr) {
+        constexpr size_t kLineBufferSize = 256;
+        std::array<char, kLineBufferSize> line{};
+        if (fgets(line.data(), line.size(), pipe) != nullptr) {
+          TRACKER_PRINT("      ");
+          if (frame_index == 0) {
+            output.PrintColored(tracker::Color::kBoldCyan,
+                                tracker::Color::kReset, "Source: %s",
+                                line.data());
           } else {
-            TRACKER_PRINT("  ");
-            if (frame_index == 0) {
-              output.PrintColored(tracker::Color::kBoldCyan,
-                                  tracker::Color::kReset, "[%zu] %s",
-                                  frame_index, symbols[i]);
-            } else {
-              TRACKER_PRINT("[%zu] %s", frame_index, symbols[i]);
-            }
-            TRACKER_PRINT("\n");
-            frame_index++;
+            TRACKER_PRINT("Source: %s", line.data());
           }
         }
-        free(symbols);
+        pclose(pipe);
       }
+      frame_index++;
+    } else {
+      TRACKER_PRINT("  ");
+      if (frame_index == 0) {
+        output.PrintColored(tracker::Color::kBoldCyan, tracker::Color::kReset,
+                            "[%zu] %s", frame_index, symbols[i]);
+      } else {
+        TRACKER_PRINT("[%zu] %s", frame_index, symbols[i]);
+      }
+      TRACKER_PRINT("\n");
+      frame_index++;
     }
   }
-  TRACKER_PRINT("\n===========================\n");
+  free(symbols);
 }
 auto MemoryTracker::HasLeaks() -> bool {
   std::lock_guard<std::mutex> lock(mutex_);
   return !allocations_.empty();
 }
 auto MemoryTracker::GetTotalAllocated() const -> size_t {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return total_allocated_;
+  return total_allocated_.load(std::memory_order_relaxed);
 }
 auto MemoryTracker::GetActiveAllocations() const -> size_t {
+  return active_allocations_.load(std::memory_order_relaxed);
+}
+auto MemoryTracker::GetCounters() const -> MemoryCounters {
+  return {total_allocated_.load(std::memory_order_relaxed),
+          total_freed_.load(std::memory_order_relaxed),
+          active_allocations_.load(std::memory_order_relaxed),
+          allocation_count_.load(std::memory_order_relaxed),
+          free_count_.load(std::memory_order_relaxed),
+          active_bytes_.load(std::memory_order_relaxed)};
+}
+auto MemoryTracker::GetSizeHistogram() const -> SizeHistogram {
+  SizeHistogram histogram;
+  for (size_t i = 0; i < kSizeClassCount; ++i) {
+    histogram.counts[i] = size_classes_[i].load(std::memory_order_relaxed);
+  }
+  histogram.sum = size_class_sum_.load(std::memory_order_relaxed);
+  return histogram;
+}
+// Approximate heap held by the allocation table: one node per entry plus
+// the bucket array.
+auto MemoryTracker::GetMetadataBytes() const -> size_t {
+  constexpr size_t kNodeOverhead = 2 * sizeof(void*);
   std::lock_guard<std::mutex> lock(mutex_);
-  return active_allocations_;
+  return allocations_.size() *
+             (sizeof(std::pair<void* const, AllocationInfo>) + kNodeOverhead) +
+         allocations_.bucket_count() * sizeof(void*) +
+         sites_.size() *
+             (sizeof(std::pair<void* const, AllocationSite>) + kNodeOverhead) +
+         sites_.bucket_count() * sizeof(void*);
 }
 auto Instance() -> MemoryTracker& { return MemoryTracker::GetInstance(); }
 }  // namespace tracker
 static auto HookedMalloc(size_t size) -> void* {
   TRACKER_DEBUG("HookedMalloc: %zu\n", size);
   void* ptr = malloc(size);
-  tracker::Instance().RecordAllocation(ptr, size);
+  {
+    tracker::HookScope scope(tracker::HookKind::kMalloc);
+    tracker::Instance().RecordAllocation(ptr, size);
+  }
   return ptr;
 }
 static auto HookedFree(void* ptr) -> void {
   TRACKER_DEBUG("HookedFree: %p\n", ptr);
-  tracker::Instance().RecordDeallocation(ptr);
+  {
+    tracker::HookScope scope(tracker::HookKind::kFree);
+    tracker::Instance().RecordDeallocation(ptr);
+  }
   free(ptr);
 }
 static auto HookedCalloc(size_t nmemb, size_t size) -> void* {
   TRACKER_DEBUG("HookedCalloc: %zu, %zu\n", nmemb, size);
   void* ptr = calloc(nmemb, size);
-  tracker::Instance().RecordAllocation(ptr, nmemb * size);
+  {
+    tracker::HookScope scope(tracker::HookKind::kCalloc);
+    tracker::Instance().RecordAllocation(ptr, nmemb * size);
+  }
   return ptr;
 }
 #pragma GCC diagnostic push
@@ -225,6 +641,7 @@ static auto HookedRealloc(void* old_ptr, size_t new_size) -> void* {
     return nullptr;
   }
   void* original_ptr = reinterpret_cast<void*>(old_addr);
+  tracker::HookScope scope(tracker::HookKind::kRealloc);
   if (new_ptr == original_ptr) {
     tracker::Instance().UpdateAllocationSize(new_ptr, new_size);
   } else {
@@ -237,7 +654,10 @@ static auto HookedRealloc(void* old_ptr, size_t new_size) -> void* {
 static auto HookedOperatorNew(size_t size) -> void* {
   TRACKER_DEBUG("HookedOperatorNew: %zu\n", size);
   void* ptr = malloc(size);
-  tracker::Instance().RecordAllocation(ptr, size);
+  {
+    tracker::HookScope scope(tracker::HookKind::kOperatorNew);
+    tracker::Instance().RecordAllocation(ptr, size);
+  }
   return ptr;
 }
 static auto HookedOperatorDelete(void* ptr) noexcept -> void {
@@ -245,13 +665,19 @@ static auto HookedOperatorDelete(void* ptr) noexcept -> void {
   if (ptr == nullptr) {
     return;
   }
-  tracker::Instance().RecordDeallocation(ptr);
+  {
+    tracker::HookScope scope(tracker::HookKind::kOperatorDelete);
+    tracker::Instance().RecordDeallocation(ptr);
+  }
   free(ptr);
 }
 static auto HookedOperatorNewArray(size_t size) -> void* {
   TRACKER_DEBUG("HookedOperatorNewArray: %zu\n", size);
   void* ptr = malloc(size);
-  tracker::Instance().RecordAllocation(ptr, size);
+  {
+    tracker::HookScope scope(tracker::HookKind::kOperatorNewArray);
+    tracker::Instance().RecordAllocation(ptr, size);
+  }
   return ptr;
 }
 static auto HookedOperatorDeleteArray(void* ptr) noexcept -> void {
@@ -259,9 +685,136 @@ static auto HookedOperatorDeleteArray(void* ptr) noexcept -> void {
   if (ptr == nullptr) {
     return;
   }
-  tracker::Instance().RecordDeallocation(ptr);
+  {
+    tracker::HookScope scope(tracker::HookKind::kOperatorDeleteArray);
+    tracker::Instance().RecordDeallocation(ptr);
+  }
   free(ptr);
 }
+// libc functions that return heap memory from their own, never hooked,
+// malloc. Recording the result here attributes it to the caller; without it
+// the caller's free is the first the tracker hears of the pointer. Errno is
+// kept intact since callers check it on failure.
+static auto RecordLibcAllocation(void* ptr, size_t size) -> void {
+  if (ptr == nullptr) {
+    return;
+  }
+  int saved_errno = errno;
+  {
+    tracker::HookScope scope(tracker::HookKind::kLibcAllocation);
+    tracker::Instance().RecordAllocation(ptr, size);
+  }
+  errno = saved_errno;
+}
+// getline and getdelim grow the caller's buffer with realloc.
+static auto RecordLineBuffer(void* old_ptr, void* new_ptr, size_t old_size,
+                             size_t new_size) -> void {
+  if (new_ptr == old_ptr && new_size == old_size) {
+    return;
+  }
+  int saved_errno = errno;
+  {
+    tracker::HookScope scope(tracker::HookKind::kLibcAllocation);
+    if (new_ptr == old_ptr) {
+      tracker::Instance().UpdateAllocationSize(new_ptr, new_size);
+    } else {
+      tracker::Instance().RecordDeallocation(old_ptr);
+      tracker::Instance().RecordAllocation(new_ptr, new_size);
+    }
+  }
+  errno = saved_errno;
+}
+static auto HookedStrdup(const char* str) -> char* {
+  char* copy = strdup(str);
+  RecordLibcAllocation(copy, copy != nullptr ? strlen(copy) + 1 : 0);
+  return copy;
+}
+static auto HookedStrndup(const char* str, size_t size) -> char* {
+  char* copy = strndup(str, size);
+  RecordLibcAllocation(copy, copy != nullptr ? strlen(copy) + 1 : 0);
+  return copy;
+}
+__attribute__((format(printf, 2, 0))) static auto HookedVasprintf(
+    char** strp, const char* format, va_list args) -> int {
+  int result = vasprintf(strp, format, args);
+  if (result >= 0) {
+    RecordLibcAllocation(*strp, static_cast<size_t>(result) + 1);
+  }
+  return result;
+}
+__attribute__((format(printf, 2, 3))) static auto HookedAsprintf(
+    char** strp, const char* format, ...) -> int {
+  va_list args;
+  va_start(args, format);
+  int result = vasprintf(strp, format, args);
+  va_end(args);
+  if (result >= 0) {
+    RecordLibcAllocation(*strp, static_cast<size_t>(result) + 1);
+  }
+  return result;
+}
+static auto HookedGetdelim(char** lineptr, size_t* size, int delim,
+                           FILE* stream) -> ssize_t {
+  char* old_ptr = *lineptr;
+  size_t old_size = *size;
+  ssize_t result = getdelim(lineptr, size, delim, stream);
+  RecordLineBuffer(old_ptr, *lineptr, old_size, *size);
+  return result;
+}
+static auto HookedGetline(char** lineptr, size_t* size, FILE* stream)
+    -> ssize_t {
+  char* old_ptr = *lineptr;
+  size_t old_size = *size;
+  ssize_t result = getline(lineptr, size, stream);
+  RecordLineBuffer(old_ptr, *lineptr, old_size, *size);
+  return result;
+}
+static auto HookedRealpath(const char* path, char* resolved) -> char* {
+  char* result = realpath(path, resolved);
+  if (resolved == nullptr && result != nullptr) {
+    RecordLibcAllocation(result, strlen(result) + 1);
+  }
+  return result;
+}
+static auto HookedOpenMemstream(char** buffer, size_t* size) -> FILE* {
+  FILE* stream = open_memstream(buffer, size);
+  if (stream != nullptr) {
+    tracker::HookScope scope(tracker::HookKind::kLibcAllocation);
+    tracker::Instance().AddMemStream(stream, buffer, size);
+  }
+  return stream;
+}
+// Only an fclose that releases a tracked memstream counts as a hook call;
+// every other stream is just forwarded.
+static auto HookedFclose(FILE* stream) -> int {
+  char** buffer = nullptr;
+  size_t* size = nullptr;
+  if (!tracker::Instance().TakeMemStream(stream, buffer, size)) {
+    return fclose(stream);
+  }
+  int result = fclose(stream);
+  RecordLibcAllocation(*buffer, *size + 1);
+  return result;
+}
+using ScandirFilter = int (*)(const struct dirent*);
+using ScandirCompare = int (*)(const struct dirent**, const struct dirent**);
+// One array of entry pointers plus one allocation per entry.
+static auto HookedScandir(const char* dir, struct dirent*** namelist,
+                          ScandirFilter filter, ScandirCompare compare)
+    -> int {
+  int result = scandir(dir, namelist, filter, compare);
+  if (result < 0) {
+    return result;
+  }
+  auto count = static_cast<size_t>(result);
+  RecordLibcAllocation(*namelist, count * sizeof(struct dirent*));
+  for (size_t i = 0; i < count; ++i) {
+    struct dirent* entry = (*namelist)[i];
+    RecordLibcAllocation(
+        entry, offsetof(struct dirent, d_name) + strlen(entry->d_name) + 1);
+  }
+  return result;
+}
 class MemoryHook {
  public:
   explicit MemoryHook(std::string lib_path) : lib_path_(std::move(lib_path)) {}
@@ -309,6 +862,29 @@ auto MemoryHook::Start() -> void {
              "operator new[]");
     try_hook("_ZdaPv", reinterpret_cast<void*>(&HookedOperatorDeleteArray),
              "operator delete[]");
+    // Only reported when present; most modules import few of these.
+    auto try_hook_quiet = [&](const char* symbol, void* hook_func) {
+      if (hook_->ReplaceFunction(symbol, hook_func, nullptr) ==
+          PltHook::ErrorCode::kSuccess) {
+        hooked_functions.emplace_back(symbol);
+      }
+    };
+    try_hook_quiet("strdup", reinterpret_cast<void*>(&HookedStrdup));
+    try_hook_quiet("__strdup", reinterpret_cast<void*>(&HookedStrdup));
+    try_hook_quiet("strndup", reinterpret_cast<void*>(&HookedStrndup));
+    try_hook_quiet("__strndup", reinterpret_cast<void*>(&HookedStrndup));
+    try_hook_quiet("asprintf", reinterpret_cast<void*>(&HookedAsprintf));
+    try_hook_quiet("vasprintf", reinterpret_cast<void*>(&HookedVasprintf));
+    try_hook_quiet("getline", reinterpret_cast<void*>(&HookedGetline));
+    try_hook_quiet("getdelim", reinterpret_cast<void*>(&HookedGetdelim));
+    try_hook_quiet("__getdelim", reinterpret_cast<void*>(&HookedGetdelim));
+    try_hook_quiet("realpath", reinterpret_cast<void*>(&HookedRealpath));
+    try_hook_quiet("open_memstream",
+                   reinterpret_cast<void*>(&HookedOpenMemstream));
+    try_hook_quiet("fclose", reinterpret_cast<void*>(&HookedFclose));
+    try_hook_quiet("scandir", reinterpret_cast<void*>(&HookedScandir));
+    try_hook_quiet("scandir64", reinterpret_cast<void*>(&HookedScandir));
+    tracker::ReportSection section;
     auto& output = tracker::OutputControl::Instance();
     output.PrintColored(tracker::Color::kGreen, tracker::Color::kReset,
                         "Successfully hooked functions: ");
@@ -342,11 +918,23 @@ class MemoryDetectImpl {
   auto RegisterMain() -> void;
   auto Start() -> void;
   auto Detect() -> void;
+  auto DetectIncremental() -> void;
+  auto GetCounters() const -> MemoryCounters;
+  auto GetSizeHistogram() const -> SizeHistogram;
+  auto GetTopSites(size_t count) const -> std::vector<AllocationSite>;
+  auto GetMetadataBytes() const -> size_t;
+  auto SetSamplePeriod(uint32_t period) -> void;
+  auto GetSamplePeriod() const -> uint32_t;
+  auto PrintTopSites(size_t count) -> void;
+  auto Checkpoint() -> void;
+  auto PrintDiff() -> void;
 
  private:
   std::vector<std::unique_ptr<MemoryHook>> hooks_;
 };
-MemoryDetectImpl::MemoryDetectImpl() = default;
+// The tracker is built along with the detector, so lock-free readers such as
+// the signal dump never run its initialization.
+MemoryDetectImpl::MemoryDetectImpl() { tracker::Instance(); }
 auto MemoryDetectImpl::Register(const std::string& lib_name) -> void {
   hooks_.emplace_back(std::make_unique<MemoryHook>(lib_name));
 }
@@ -354,11 +942,44 @@ auto MemoryDetectImpl::RegisterMain() -> void {
   hooks_.emplace_back(std::make_unique<MemoryHook>(std::string()));
 }
 auto MemoryDetectImpl::Start() -> void {
+  // Construct the tracker before any hook can fire, so it is never first
+  // built inside a hooked call and outlives exit handlers registered later.
+  tracker::Instance();
+  tracker::OverheadAccounting::Instance().Start();
   for (auto& hook : hooks_) {
     hook->Start();
   }
 }
 auto MemoryDetectImpl::Detect() -> void { tracker::Instance().PrintStatus(); }
+auto MemoryDetectImpl::GetCounters() const -> MemoryCounters {
+  return tracker::Instance().GetCounters();
+}
+auto MemoryDetectImpl::GetSizeHistogram() const -> SizeHistogram {
+  return tracker::Instance().GetSizeHistogram();
+}
+auto MemoryDetectImpl::GetTopSites(size_t count) const
+    -> std::vector<AllocationSite> {
+  return tracker::Instance().GetTopSites(count);
+}
+auto MemoryDetectImpl::GetMetadataBytes() const -> size_t {
+  return tracker::Instance().GetMetadataBytes();
+}
+auto MemoryDetectImpl::SetSamplePeriod(uint32_t period) -> void {
+  tracker::Instance().SetSamplePeriod(period);
+}
+auto MemoryDetectImpl::GetSamplePeriod() const -> uint32_t {
+  return tracker::Instance().GetSamplePeriod();
+}
+auto MemoryDetectImpl::PrintTopSites(size_t count) -> void {
+  tracker::Instance().PrintTopSites(count);
+}
+auto MemoryDetectImpl::Checkpoint() -> void {
+  tracker::Instance().Checkpoint();
+}
+auto MemoryDetectImpl::PrintDiff() -> void { tracker::Instance().PrintDiff(); }
+auto MemoryDetectImpl::DetectIncremental() -> void {
+  tracker::Instance().PrintIncrementalStatus();
+}
 MemoryDetect::MemoryDetect() : impl_(std::make_unique<MemoryDetectImpl>()) {}
 auto MemoryDetect::Register(const std::string& lib_name) -> void {
   impl_->Register(lib_name);
@@ -366,4 +987,29 @@ auto MemoryDetect::Register(const std::string& lib_name) -> void {
 auto MemoryDetect::RegisterMain() -> void { impl_->RegisterMain(); }
 auto MemoryDetect::Start() -> void { impl_->Start(); }
 auto MemoryDetect::Detect() -> void { impl_->Detect(); }
+auto MemoryDetect::DetectIncremental() -> void { impl_->DetectIncremental(); }
+auto MemoryDetect::GetCounters() const -> MemoryCounters {
+  return impl_->GetCounters();
+}
+auto MemoryDetect::GetSizeHistogram() const -> SizeHistogram {
+  return impl_->GetSizeHistogram();
+}
+auto MemoryDetect::GetTopSites(size_t count) const
+    -> std::vector<AllocationSite> {
+  return impl_->GetTopSites(count);
+}
+auto MemoryDetect::GetMetadataBytes() const -> size_t {
+  return impl_->GetMetadataBytes();
+}
+auto MemoryDetect::SetSamplePeriod(uint32_t period) -> void {
+  impl_->SetSamplePeriod(period);
+}
+auto MemoryDetect::GetSamplePeriod() const -> uint32_t {
+  return impl_->GetSamplePeriod();
+}
+auto MemoryDetect::PrintTopSites(size_t count) -> void {
+  impl_->PrintTopSites(count);
+}
+auto MemoryDetect::Checkpoint() -> void { impl_->Checkpoint(); }
+auto MemoryDetect::PrintDiff() -> void { impl_->PrintDiff(); }
 MemoryDetect::~MemoryDetect() { impl_.reset(); }
@@ -1,54 +1,133 @@
 #include "output_control.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <array>
+#include <cerrno>
 #include <cstring>
 #include <ctime>
 namespace tracker {
+static auto MakeDirectories(const std::string& path) -> void {
+  constexpr mode_t kDirMode = 0755;
+  size_t pos = 0;
+  while (pos != std::string::npos) {
+    pos = path.find('/', pos + 1);
+    std::string prefix = path.substr(0, pos);
+    if (prefix.empty()) {
+      continue;
+    }
+    if (mkdir(prefix.c_str(), kDirMode) != 0 && errno != EEXIST) {
+      return;
+    }
+  }
+}
+static auto OpenLogFile(const std::string& name) -> int {
+  size_t last_slash = name.find_last_of('/');
+  if (last_slash != std::string::npos) {
+    MakeDirectories(name.substr(0, last_slash));
+  }
+  constexpr mode_t kFileMode = 0644;
+  return open(name.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+              kFileMode);
+}
 auto OutputControl::Configure(OutputOption option, const std::string& filename)
     -> void {
+  std::lock_guard<std::mutex> lock(file_mutex_);
   CloseOutputFile();
   output_option_ = option;
   output_file_name_ = filename;
+  if (output_file_name_.empty()) {
+    time_t now = time(nullptr);
+    constexpr size_t kTimestampBufferSize = 32;
+    std::array<char, kTimestampBufferSize> timestamp{};
+    strftime(timestamp.data(), timestamp.size(), "%Y%m%d_%H%M%S_",
+             localtime(&now));
+    output_file_name_ = std::string(timestamp.data()) + "detector.log";
+  }
   if (option != OutputOption::kOutputOptionConsole) {
     OpenOutputFile();
   }
 }
+auto OutputControl::SetRotation(size_t max_file_bytes, size_t max_files)
+    -> void {
+  std::lock_guard<std::mutex> lock(file_mutex_);
+  max_file_bytes_ = max_file_bytes;
+  max_files_ = max_files;
+}
+// The final report is printed from an atexit handler, which runs after the
+// exiting thread's thread_local destructors; from then on output goes out
+// unbuffered.
+static thread_local bool section_buffer_destroyed = false;
+// Nesting of ReportSections on this thread. Unlike section_buffer it is
+// trivially destructible, so it still tells report boundaries apart in the
+// atexit report.
+static thread_local int section_depth = 0;
+struct SectionBuffer {
+  int depth = 0;
+  std::string console;
+  std::string file;
+  std::string* capture = nullptr;
+  ~SectionBuffer() { section_buffer_destroyed = true; }
+};
+static thread_local SectionBuffer section_buffer;
+static auto Capture() -> std::string* {
+  return section_buffer_destroyed ? nullptr : section_buffer.capture;
+}
+static auto Buffering() -> bool {
+  return !section_buffer_destroyed && section_buffer.depth > 0;
+}
+static auto AppendFormatted(std::string& out, const char* format,
+                            va_list args) -> void {
+  va_list args_copy;
+  va_copy(args_copy, args);
+  int length = vsnprintf(nullptr, 0, format, args_copy);
+  va_end(args_copy);
+  if (length <= 0) {
+    return;
+  }
+  size_t offset = out.size();
+  out.resize(offset + static_cast<size_t>(length) + 1);
+  vsnprintf(out.data() + offset, static_cast<size_t>(length) + 1, format,
+            args);
+  out.resize(offset + static_cast<size_t>(length));
+}
 auto OutputControl::Print(const char* format, ...) const -> void {
   va_list args1;
   va_list args2;
   va_start(args1, format);
+  if (std::string* capture = Capture(); capture != nullptr) {
+    AppendFormatted(*capture, format, args1);
+    va_end(args1);
+    return;
+  }
   if (output_option_ == OutputOption::kOutputOptionConsoleFile ||
       output_option_ == OutputOption::kOutputOptionConsole) {
     va_copy(args2, args1);
-    vprintf(format, args2);
+    WriteToConsole(nullptr, nullptr, format, args2);
     va_end(args2);
   }
-  if ((output_option_ == OutputOption::kOutputOptionConsoleFile ||
-       output_option_ == OutputOption::kOutputOptionFile) &&
-      output_file_ != nullptr) {
-    vfprintf(output_file_, format, args1);
-    fflush(output_file_);
+  if (output_option_ == OutputOption::kOutputOptionConsoleFile ||
+      output_option_ == OutputOption::kOutputOptionFile) {
+    WriteToFile(format, args1);
   }
   va_end(args1);
 }
 auto OutputControl::PrintToFile(const char* format, ...) const -> void {
-  if (output_file_ == nullptr ||
-      output_option_ == OutputOption::kOutputOptionConsole) {
+  if (output_option_ == OutputOption::kOutputOptionConsole) {
     return;
   }
   va_list args;
   va_start(args, format);
-  vfprintf(output_file_, format, args);
-  fflush(output_file_);
+  WriteToFile(format, args);
   va_end(args);
 }
 auto OutputControl::PrintToConsole(const char* format, ...) const -> void {
   va_list args;
   va_start(args, format);
-  vprintf(format, args);
+  WriteToConsole(nullptr, nullptr, format, args);
   va_end(args);
 }
 auto OutputControl::PrintColored(const char* color_start, const char* color_end,
@@ -56,50 +135,168 @@ auto OutputControl::PrintColored(const char* color_start, const char* color_end,
   va_list args1;
   va_list args2;
   va_start(args1, format);
+  if (std::string* capture = Capture(); capture != nullptr) {
+    AppendFormatted(*capture, format, args1);
+    va_end(args1);
+    return;
+  }
   if (output_option_ == OutputOption::kOutputOptionConsoleFile ||
       output_option_ == OutputOption::kOutputOptionConsole) {
     va_copy(args2, args1);
-    printf("%s", color_start);
-    vprintf(format, args2);
-    printf("%s", color_end);
+    WriteToConsole(color_start, color_end, format, args2);
     va_end(args2);
   }
-  if ((output_option_ == OutputOption::kOutputOptionConsoleFile ||
-       output_option_ == OutputOption::kOutputOptionFile) &&
-      output_file_ != nullptr) {
-    vfprintf(output_file_, format, args1);
-    fflush(output_file_);
+  if (output_option_ == OutputOption::kOutputOptionConsoleFile ||
+      output_option_ == OutputOption::kOutputOptionFile) {
+    WriteToFile(format, args1);
   }
   va_end(args1);
 }
-auto OutputControl::OpenOutputFile() -> void {
-  std::string filename = output_file_name_;
-  if (filename.empty()) {
-    time_t now = time(nullptr);
-    constexpr size_t kTimestampBufferSize = 32;
-    std::array<char, kTimestampBufferSize> timestamp{};
-    strftime(timestamp.data(), timestamp.size(), "%Y%m%d_%H%M%S_",
-             localtime(&now));
-    filename = std::string(timestamp.data()) + "detector.log";
+auto OutputControl::BeginSection() const -> void {
+  ++section_depth;
+  if (!section_buffer_destroyed) {
+    section_buffer.depth++;
   }
-  size_t last_slash = filename.find_last_of('/');
-  if (last_slash != std::string::npos) {
-    std::string dir_path = filename.substr(0, last_slash);
-    std::string cmd = "mkdir -p \"" + dir_path + "\" 2>/dev/null";
-    if (system(cmd.c_str()) < 0) {
-      // Ignore mkdir failure, file open will fail later if needed
+}
+auto OutputControl::EndSection() const -> void {
+  if (section_depth > 0) {
+    --section_depth;
+  }
+  if (!Buffering()) {
+    // An unbuffered report went out line by line and could not rotate midway;
+    // its end is the first point where it may.
+    if (section_depth == 0) {
+      std::lock_guard<std::mutex> lock(file_mutex_);
+      RotateIfFull();
+    }
+    return;
+  }
+  if (--section_buffer.depth > 0) {
+    return;
+  }
+  if (!section_buffer.console.empty()) {
+    fwrite(section_buffer.console.data(), 1, section_buffer.console.size(),
+           stdout);
+    fflush(stdout);
+    section_buffer.console.clear();
+  }
+  if (!section_buffer.file.empty()) {
+    PublishToFile(section_buffer.file);
+    section_buffer.file.clear();
+  }
+}
+auto OutputControl::BeginCapture(std::string* target) const -> void {
+  if (!section_buffer_destroyed) {
+    section_buffer.capture = target;
+  }
+}
+auto OutputControl::EndCapture() const -> void {
+  if (!section_buffer_destroyed) {
+    section_buffer.capture = nullptr;
+  }
+}
+auto OutputControl::WriteToConsole(const char* color_start,
+                                   const char* color_end, const char* format,
+                                   va_list args) const -> void {
+  if (Buffering()) {
+    if (color_start != nullptr) {
+      section_buffer.console += color_start;
+    }
+    AppendFormatted(section_buffer.console, format, args);
+    if (color_end != nullptr) {
+      section_buffer.console += color_end;
+    }
+    return;
+  }
+  if (color_start != nullptr) {
+    printf("%s", color_start);
+  }
+  vprintf(format, args);
+  if (color_end != nullptr) {
+    printf("%s", color_end);
+  }
+}
+auto OutputControl::WriteToFile(const char* format, va_list args) const
+    -> void {
+  if (Buffering()) {
+    AppendFormatted(section_buffer.file, format, args);
+    return;
+  }
+  std::string text;
+  AppendFormatted(text, format, args);
+  PublishToFile(text);
+}
+auto OutputControl::PublishToFile(const std::string& text) const -> void {
+  std::lock_guard<std::mutex> lock(file_mutex_);
+  if (output_file_ == nullptr || text.empty()) {
+    return;
+  }
+  size_t written = fwrite(text.data(), 1, text.size(), output_file_);
+  fflush(output_file_);
+  file_bytes_ += written;
+  if (section_depth == 0) {
+    RotateIfFull();
+  }
+}
+auto OutputControl::RotateIfFull() const -> void {
+  if (output_file_ != nullptr && max_file_bytes_ != 0 &&
+      file_bytes_ >= max_file_bytes_) {
+    RotateOutputFile();
+  }
+}
+// Shift "name.1" .. "name.N-2" up by one, move the active file to "name.1" and
+// start a fresh one. The oldest file falls off the end. The fresh file is
+// dup3'ed over the current descriptor, so output_file_ and output_fd_ never
+// point at a closed file.
+auto OutputControl::RotateOutputFile() const -> void {
+  if (max_files_ <= 1) {
+    unlink(output_file_name_.c_str());
+  } else {
+    auto rotated_name = [this](size_t index) {
+      return output_file_name_ + "." + std::to_string(index);
+    };
+    unlink(rotated_name(max_files_ - 1).c_str());
+    for (size_t i = max_files_ - 1; i > 1; --i) {
+      rename(rotated_name(i - 1).c_str(), rotated_name(i).c_str());
+    }
+    rename(output_file_name_.c_str(), rotated_name(1).c_str());
+  }
+  file_bytes_ = 0;
+  int fd = OpenLogFile(output_file_name_);
+  if (fd < 0) {
+    // Keep appending to the renamed file and retry after another
+    // max_file_bytes_.
+    printf("Failed to open output file: %s\n", output_file_name_.c_str());
+    return;
+  }
+  dup3(fd, fileno(output_file_), O_CLOEXEC);
+  close(fd);
+}
+auto OutputControl::OpenOutputFile() const -> void {
+  int fd = OpenLogFile(output_file_name_);
+  if (fd >= 0) {
+    output_file_ = fdopen(fd, "a");
+    if (output_file_ == nullptr) {
+      close(fd);
     }
   }
-  output_file_ = fopen(filename.c_str(), "w");
   if (output_file_ == nullptr) {
-    printf("Failed to open output file: %s\n", filename.c_str());
+    printf("Failed to open output file: %s\n", output_file_name_.c_str());
+    return;
   }
+  output_fd_.store(fd, std::memory_order_release);
+  struct stat file_stat {};
+  file_bytes_ = fstat(fd, &file_stat) == 0
+                    ? static_cast<size_t>(file_stat.st_size)
+                    : 0;
 }
-auto OutputControl::CloseOutputFile() -> void {
+auto OutputControl::CloseOutputFile() const -> void {
   if (output_file_ != nullptr) {
+    output_fd_.store(-1, std::memory_order_release);
     fclose(output_file_);
     output_file_ = nullptr;
   }
+  file_bytes_ = 0;
 }
 OutputControl::~OutputControl() { CloseOutputFile(); }
 }  // namespace tracker
@@ -0,0 +1,314 @@
+#include "overhead.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "detector.h"
+#include "lock_detect.h"
+#include "memory_detect.h"
+#include "output_control.h"
+namespace tracker {
+namespace {
+// Threads are spread over cache-line-aligned stripes so the hooks never
+// share a counter line with another busy thread.
+constexpr size_t kOverheadStripes = 32;
+struct alignas(64) OverheadStripe {
+  std::array<std::atomic<uint64_t>, kHookKindCount> calls{};
+  std::array<std::array<std::atomic<uint64_t>, kOverheadPhaseCount>,
+             kHookKindCount>
+      cycles{};
+};
+std::array<OverheadStripe, kOverheadStripes> g_stripes;
+std::atomic<size_t> g_next_stripe = 0;
+std::atomic<bool> g_started = false;
+uint64_t g_start_cycles = 0;
+uint64_t g_start_wall_ns = 0;
+uint64_t g_start_cpu_ns = 0;
+auto Stripe() -> OverheadStripe& {
+  static thread_local size_t index =
+      g_next_stripe.fetch_add(1, std::memory_order_relaxed) %
+      kOverheadStripes;
+  return g_stripes[index];
+}
+auto ClockNs(clockid_t clock) -> uint64_t {
+  constexpr uint64_t kNsPerSecond = 1000000000;
+  timespec ts{};
+  clock_gettime(clock, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * kNsPerSecond +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+}  // namespace
+auto HookKindName(HookKind kind) -> const char* {
+  switch (kind) {
+    case HookKind::kMalloc:
+      return "malloc";
+    case HookKind::kFree:
+      return "free";
+    case HookKind::kCalloc:
+      return "calloc";
+    case HookKind::kRealloc:
+      return "realloc";
+    case HookKind::kOperatorNew:
+      return "operator new";
+    case HookKind::kOperatorDelete:
+      return "operator delete";
+    case HookKind::kOperatorNewArray:
+      return "operator new[]";
+    case HookKind::kOperatorDeleteArray:
+      return "operator delete[]";
+    case HookKind::kLibcAllocation:
+      return "strdup, getline, ...";
+    case HookKind::kMutexLock:
+      return "pthread_mutex_lock";
+    case HookKind::kMutexUnlock:
+      return "pthread_mutex_unlock";
+    case HookKind::kMutexTrylock:
+      return "pthread_mutex_trylock";
+    case HookKind::kMutexDestroy:
+      return "pthread_mutex_destroy";
+    case HookKind::kRead:
+      return "read";
+    case HookKind::kWrite:
+      return "write";
+    case HookKind::kPread:
+      return "pread";
+    case HookKind::kPwrite:
+      return "pwrite";
+    case HookKind::kReadv:
+      return "readv";
+    case HookKind::kWritev:
+      return "writev";
+    case HookKind::kFsync:
+      return "fsync";
+    case HookKind::kFdatasync:
+      return "fdatasync";
+    case HookKind::kSend:
+      return "send";
+    case HookKind::kRecv:
+      return "recv";
+    case HookKind::kSendmsg:
+      return "sendmsg";
+    case HookKind::kRecvmsg:
+      return "recvmsg";
+    case HookKind::kPthreadCreate:
+      return "pthread_create";
+    case HookKind::kPthreadJoin:
+      return "pthread_join";
+    case HookKind::kPthreadDetach:
+      return "pthread_detach";
+    case HookKind::kPthreadExit:
+      return "pthread_exit";
+    case HookKind::kPoll:
+      return "poll";
+    case HookKind::kPpoll:
+      return "ppoll";
+    case HookKind::kEpollWait:
+      return "epoll_wait";
+    case HookKind::kEpollPwait:
+      return "epoll_pwait";
+    case HookKind::kSelect:
+      return "select";
+    case HookKind::kPselect:
+      return "pselect";
+    case HookKind::kNanosleep:
+      return "nanosleep";
+    case HookKind::kClockNanosleep:
+      return "clock_nanosleep";
+    case HookKind::kUsleep:
+      return "usleep";
+    case HookKind::kSleep:
+      return "sleep";
+    case HookKind::kAccept:
+      return "accept";
+    case HookKind::kAccept4:
+      return "accept4";
+    case HookKind::kConnect:
+      return "connect";
+    case HookKind::kCondWait:
+      return "pthread_cond_wait";
+    case HookKind::kCondTimedwait:
+      return "pthread_cond_timedwait";
+    case HookKind::kSemWait:
+      return "sem_wait";
+    case HookKind::kSemTimedwait:
+      return "sem_timedwait";
+    case HookKind::kRwlockRdlock:
+      return "pthread_rwlock_rdlock";
+    case HookKind::kRwlockWrlock:
+      return "pthread_rwlock_wrlock";
+    case HookKind::kWaitpid:
+      return "waitpid";
+    case HookKind::kWait:
+      return "wait";
+    case HookKind::kFdOpen:
+      return "fd open";
+    case HookKind::kFdClose:
+      return "close";
+    case HookKind::kMemcpy:
+      return "memcpy";
+    case HookKind::kMemmove:
+      return "memmove";
+    case HookKind::kMemset:
+      return "memset";
+    case HookKind::kStrcpy:
+      return "strcpy";
+    case HookKind::kStrlen:
+      return "strlen";
+    case HookKind::kCxaAllocateException:
+      return "__cxa_allocate_exception";
+    case HookKind::kCxaThrow:
+      return "__cxa_throw";
+    case HookKind::kCxaBeginCatch:
+      return "__cxa_begin_catch";
+    case HookKind::kCount:
+      break;
+  }
+  return "?";
+}
+auto OverheadAccounting::Instance() -> OverheadAccounting& {
+  static OverheadAccounting instance;
+  return instance;
+}
+auto OverheadAccounting::Start() -> void {
+  if (g_started.exchange(true)) {
+    return;
+  }
+  g_start_wall_ns = ClockNs(CLOCK_MONOTONIC);
+  g_start_cpu_ns = ClockNs(CLOCK_PROCESS_CPUTIME_ID);
+  g_start_cycles = ReadCycles();
+}
+auto OverheadAccounting::CountCall(HookKind kind) -> void {
+  Stripe().calls[static_cast<size_t>(kind)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+auto OverheadAccounting::AddCycles(HookKind kind, OverheadPhase phase,
+                                   uint64_t cycles) -> void {
+  Stripe()
+      .cycles[static_cast<size_t>(kind)][static_cast<size_t>(phase)]
+      .fetch_add(cycles, std::memory_order_relaxed);
+}
+auto OverheadAccounting::GetCounters(int detect_option) const
+    -> OverheadCounters {
+  OverheadCounters counters;
+  for (const auto& stripe : g_stripes) {
+    for (size_t kind = 0; kind < kHookKindCount; ++kind) {
+      counters.calls[kind] +=
+          stripe.calls[kind].load(std::memory_order_relaxed);
+      for (size_t phase = 0; phase < kOverheadPhaseCount; ++phase) {
+        counters.cycles[kind][phase] +=
+            stripe.cycles[kind][phase].load(std::memory_order_relaxed);
+      }
+    }
+  }
+  uint64_t record_cycles = 0;
+  uint64_t unwind_cycles = 0;
+  uint64_t table_cycles = 0;
+  for (size_t kind = 0; kind < kHookKindCount; ++kind) {
+    const auto& cycles = counters.cycles[kind];
+    counters.hooked_calls += counters.calls[kind];
+    record_cycles += cycles[static_cast<size_t>(OverheadPhase::kRecord)];
+    unwind_cycles += cycles[static_cast<size_t>(OverheadPhase::kUnwind)];
+    table_cycles += cycles[static_cast<size_t>(OverheadPhase::kTable)];
+  }
+  if (g_started.load()) {
+    counters.wall_ns = ClockNs(CLOCK_MONOTONIC) - g_start_wall_ns;
+    counters.cpu_ns = ClockNs(CLOCK_PROCESS_CPUTIME_ID) - g_start_cpu_ns;
+    uint64_t elapsed_cycles = ReadCycles() - g_start_cycles;
+    if (elapsed_cycles != 0) {
+      double ns_per_cycle = static_cast<double>(counters.wall_ns) /
+                            static_cast<double>(elapsed_cycles);
+      counters.overhead_ns = static_cast<uint64_t>(
+          static_cast<double>(record_cycles) * ns_per_cycle);
+      counters.unwind_ns = static_cast<uint64_t>(
+          static_cast<double>(unwind_cycles) * ns_per_cycle);
+      counters.table_ns = static_cast<uint64_t>(
+          static_cast<double>(table_cycles) * ns_per_cycle);
+    }
+  }
+  constexpr double kPercent = 100.0;
+  if (counters.wall_ns != 0) {
+    counters.wall_percent = static_cast<double>(counters.overhead_ns) *
+                            kPercent / static_cast<double>(counters.wall_ns);
+  }
+  if (counters.cpu_ns != 0) {
+    counters.cpu_percent = static_cast<double>(counters.overhead_ns) *
+                           kPercent / static_cast<double>(counters.cpu_ns);
+  }
+  if ((detect_option & kDetectorOptionMemory) != 0) {
+    counters.metadata_bytes += MemoryDetect::GetInstance().GetMetadataBytes();
+  }
+  if ((detect_option & kDetectorOptionLock) != 0) {
+    counters.metadata_bytes += LockDetect::GetInstance().GetMetadataBytes();
+  }
+  return counters;
+}
+auto OverheadAccounting::Print(int detect_option) const -> void {
+  constexpr double kNsPerMs = 1000000.0;
+  OverheadCounters counters = GetCounters(detect_option);
+  ReportSection section;
+  TRACKER_PRINT("\n=== Detector Overhead ===\n");
+  TRACKER_PRINT("Hooked calls: %lu\n", counters.hooked_calls);
+  TRACKER_PRINT("Time in detector: %.2f ms (%.3f%% of wall, %.3f%% of CPU)\n",
+                static_cast<double>(counters.overhead_ns) / kNsPerMs,
+                counters.wall_percent, counters.cpu_percent);
+  TRACKER_PRINT("Metadata memory: %zu bytes\n", counters.metadata_bytes);
+  TRACKER_PRINT("%-22s %12s %14s %14s %14s %14s\n", "hook", "calls",
+                "record cyc", "unwind cyc", "table cyc", "lock cyc");
+  for (size_t kind = 0; kind < kHookKindCount; ++kind) {
+    if (counters.calls[kind] == 0) {
+      continue;
+    }
+    const auto& cycles = counters.cycles[kind];
+    TRACKER_PRINT("%-22s %12lu %14lu %14lu %14lu %14lu\n",
+                  HookKindName(static_cast<HookKind>(kind)),
+                  counters.calls[kind], cycles[0], cycles[1], cycles[2],
+                  cycles[3]);
+  }
+  TRACKER_PRINT("=========================\n");
+}
+auto OverheadGovernor::Update() -> void {
+  constexpr uint32_t kMaxPeriod = 4096;
+  constexpr double kPercent = 100.0;
+  // Relax only when comfortably under budget, to avoid oscillating.
+  constexpr double kRelaxRatio = 0.5;
+  // Option 0: the controller only needs the cheap counters, not the
+  // metadata walk.
+  OverheadCounters counters = OverheadAccounting::Instance().GetCounters(0);
+  uint64_t overhead_ns = counters.overhead_ns - last_overhead_ns_;
+  uint64_t cpu_ns = counters.cpu_ns - last_cpu_ns_;
+  last_overhead_ns_ = counters.overhead_ns;
+  last_cpu_ns_ = counters.cpu_ns;
+  if (cpu_ns == 0 || budget_percent_ <= 0.0) {
+    return;
+  }
+  double percent = static_cast<double>(overhead_ns) * kPercent /
+                   static_cast<double>(cpu_ns);
+  double ratio = percent / budget_percent_;
+  uint32_t period = period_;
+  if (ratio > 1.0) {
+    double scaled = std::ceil(static_cast<double>(period) * ratio);
+    period = static_cast<uint32_t>(
+        std::min(std::max(scaled, 2.0 * period), double{kMaxPeriod}));
+  } else if (ratio < kRelaxRatio) {
+    period = std::max<uint32_t>(period / 2, 1);
+  }
+  if (period != period_) {
+    TRACKER_PRINT(
+        "Overhead governor: %.2f%% CPU (budget %.2f%%), stack sampling 1/%u\n",
+        percent, budget_percent_, period);
+    Apply(period);
+  }
+}
+auto OverheadGovernor::Apply(uint32_t period) -> void {
+  period_ = period;
+  if ((detect_option_ & kDetectorOptionMemory) != 0) {
+    MemoryDetect::GetInstance().SetSamplePeriod(period);
+  }
+  if ((detect_option_ & kDetectorOptionLock) != 0) {
+    LockDetect::GetInstance().SetStackSamplePeriod(period);
+  }
+}
+}  // namespace tracker
@@ -0,0 +1,115 @@
+#include "prometheus_export.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdarg>
+#include <cstdio>
+
+#include "detector.h"
+#include "lock_detect.h"
+#include "memory_detect.h"
+namespace tracker {
+static auto Append(std::string& out, const char* format, ...) -> void {
+  constexpr size_t kLineBufferSize = 256;
+  std::array<char, kLineBufferSize> line{};
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line.data(), line.size(), format, args);
+  va_end(args);
+  if (length > 0) {
+    out.append(line.data(),
+               std::min(static_cast<size_t>(length), line.size() - 1));
+  }
+}
+// Counters and histograms only, all read lock-free. There are no per-lock
+// series: the tracker knows locks only by address, which is neither a
+// stable label nor of bounded cardinality.
+auto PrometheusExporter::Render() -> std::string {
+  constexpr size_t kSmallestClassBytes = 16;
+  std::string out;
+  auto now = std::chrono::steady_clock::now();
+  double elapsed_s = std::chrono::duration<double>(now - last_render_).count();
+  bool has_rate = last_render_.time_since_epoch().count() != 0 && elapsed_s > 0;
+  last_render_ = now;
+  if ((detect_option_ & kDetectorOptionMemory) != 0) {
+    MemoryCounters counters = MemoryDetect::GetInstance().GetCounters();
+    Append(out, "# TYPE nv_detector_live_bytes gauge\n");
+    Append(out, "nv_detector_live_bytes %zu\n", counters.active_bytes);
+    Append(out, "# TYPE nv_detector_live_objects gauge\n");
+    Append(out, "nv_detector_live_objects %zu\n", counters.active_allocations);
+    Append(out, "# TYPE nv_detector_allocations_total counter\n");
+    Append(out, "nv_detector_allocations_total %zu\n",
+           counters.allocation_count);
+    Append(out, "# TYPE nv_detector_frees_total counter\n");
+    Append(out, "nv_detector_frees_total %zu\n", counters.free_count);
+    if (has_rate) {
+      Append(out, "# TYPE nv_detector_allocations_per_second gauge\n");
+      Append(out, "nv_detector_allocations_per_second %.3f\n",
+             static_cast<double>(counters.allocation_count -
+                                 last_allocation_count_) /
+                 elapsed_s);
+      Append(out, "# TYPE nv_detector_frees_per_second gauge\n");
+      Append(out, "nv_detector_frees_per_second %.3f\n",
+             static_cast<double>(counters.free_count - last_free_count_) /
+                 elapsed_s);
+    }
+    last_allocation_count_ = counters.allocation_count;
+    last_free_count_ = counters.free_count;
+    SizeHistogram histogram = MemoryDetect::GetInstance().GetSizeHistogram();
+    Append(out, "# TYPE nv_detector_allocation_size_bytes histogram\n");
+    size_t cumulative = 0;
+    for (size_t i = 0; i + 1 < kSizeClassCount; ++i) {
+      cumulative += histogram.counts[i];
+      Append(out, "nv_detector_allocation_size_bytes_bucket{le=\"%zu\"} %zu\n",
+             kSmallestClassBytes << i, cumulative);
+    }
+    cumulative += histogram.counts[kSizeClassCount - 1];
+    Append(out, "nv_detector_allocation_size_bytes_bucket{le=\"+Inf\"} %zu\n",
+           cumulative);
+    Append(out, "nv_detector_allocation_size_bytes_sum %zu\n", histogram.sum);
+    Append(out, "nv_detector_allocation_size_bytes_count %zu\n", cumulative);
+  }
+  if ((detect_option_ & kDetectorOptionLock) != 0) {
+    constexpr double kNsPerSecond = 1e9;
+    LockCounters counters = LockDetect::GetInstance().GetCounters();
+    Append(out, "# TYPE nv_detector_lock_acquisitions_total counter\n");
+    Append(out, "nv_detector_lock_acquisitions_total %zu\n",
+           counters.acquisitions);
+    Append(out, "# TYPE nv_detector_lock_contended_total counter\n");
+    Append(out, "nv_detector_lock_contended_total %zu\n",
+           counters.contended_acquisitions);
+    Append(out, "# TYPE nv_detector_lock_wait_seconds_total counter\n");
+    Append(out, "nv_detector_lock_wait_seconds_total %.9f\n",
+           static_cast<double>(counters.total_wait_ns) / kNsPerSecond);
+    Append(out, "# TYPE nv_detector_deadlocks_total counter\n");
+    Append(out, "nv_detector_deadlocks_total %zu\n",
+           counters.deadlocks_detected);
+  }
+  return out;
+}
+auto PrometheusExporter::WriteFile(const std::string& path) -> bool {
+  std::string text = Render();
+  std::string temp_path = path + ".tmp";
+  constexpr mode_t kFileMode = 0644;
+  int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                kFileMode);
+  if (fd < 0) {
+    return false;
+  }
+  size_t written = 0;
+  while (written < text.size()) {
+    ssize_t n = write(fd, text.data() + written, text.size() - written);
+    if (n <= 0) {
+      close(fd);
+      unlink(temp_path.c_str());
+      return false;
+    }
+    written += static_cast<size_t>(n);
+  }
+  close(fd);
+  return rename(temp_path.c_str(), path.c_str()) == 0;
+}
+}  // namespace tracker
@@ -0,0 +1,163 @@
+#include "stats_segment.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "detector.h"
+#include "lock_detect.h"
+#include "memory_detect.h"
+#include "output_control.h"
+namespace tracker {
+static_assert(kNvStatsSizeClasses == kSizeClassCount,
+              "segment layout must match the tracker size classes");
+// Seqlock writer: odd while the section is being rewritten.
+template <typename Data, typename Writer>
+static auto WriteSection(NvStatsSection<Data>& section, Writer&& writer)
+    -> void {
+  uint64_t sequence = section.sequence.load(std::memory_order_relaxed);
+  section.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  section.data.update_ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+  writer(section.data);
+  section.sequence.store(sequence + 2, std::memory_order_release);
+}
+auto StatsSegment::Create() -> bool {
+  if (segment_ != nullptr) {
+    return true;
+  }
+  name_ = NvStatsSegmentName(getpid());
+  constexpr mode_t kSegmentMode = 0600;
+  int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                    kSegmentMode);
+  if (fd < 0) {
+    TRACKER_ERROR("Failed to create stats segment %s: %s\n", name_.c_str(),
+                  strerror(errno));
+    return false;
+  }
+  if (ftruncate(fd, sizeof(NvStatsSegment)) != 0) {
+    close(fd);
+    shm_unlink(name_.c_str());
+    return false;
+  }
+  void* addr = mmap(nullptr, sizeof(NvStatsSegment), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    shm_unlink(name_.c_str());
+    return false;
+  }
+  // ftruncate zero-fills, which is a valid state for every section
+  segment_ = static_cast<NvStatsSegment*>(addr);
+  segment_->size = sizeof(NvStatsSegment);
+  segment_->pid = getpid();
+  segment_->version = kNvStatsVersion;
+  std::atomic_thread_fence(std::memory_order_release);
+  segment_->magic = kNvStatsMagic;
+  return true;
+}
+auto StatsSegment::Destroy() -> void {
+  if (segment_ == nullptr) {
+    return;
+  }
+  munmap(segment_, sizeof(NvStatsSegment));
+  shm_unlink(name_.c_str());
+  segment_ = nullptr;
+}
+// The top sites change slowly, so each address is symbolized once.
+auto StatsSegment::SymbolOf(void* site) -> NvStatsSymbol {
+  auto key = reinterpret_cast<uint64_t>(site);
+  auto it = symbols_.find(key);
+  if (it != symbols_.end()) {
+    return it->second;
+  }
+  constexpr size_t kMaxCachedSymbols = 4096;
+  if (symbols_.size() >= kMaxCachedSymbols) {
+    symbols_.clear();
+  }
+  Dl_info dlinfo;
+  const char* name = "??";
+  if (site != nullptr && dladdr(site, &dlinfo) != 0 &&
+      dlinfo.dli_sname != nullptr) {
+    name = dlinfo.dli_sname;
+  }
+  NvStatsSymbol symbol{};
+  snprintf(symbol.data(), symbol.size(), "%s", name);
+  symbols_.emplace(key, symbol);
+  return symbol;
+}
+auto StatsSegment::Publish() -> void {
+  if (segment_ == nullptr) {
+    return;
+  }
+  if ((detect_option_ & kDetectorOptionMemory) != 0) {
+    MemoryCounters counters = MemoryDetect::GetInstance().GetCounters();
+    SizeHistogram histogram = MemoryDetect::GetInstance().GetSizeHistogram();
+    WriteSection(segment_->memory, [&](NvStatsMemory& section) {
+      section.total_allocated = counters.total_allocated;
+      section.total_freed = counters.total_freed;
+      section.active_allocations = counters.active_allocations;
+      section.active_bytes = counters.active_bytes;
+      section.allocation_count = counters.allocation_count;
+      section.free_count = counters.free_count;
+      std::ranges::copy(histogram.counts, section.size_classes.begin());
+    });
+    std::vector<AllocationSite> sites =
+        MemoryDetect::GetInstance().GetTopSites(kNvStatsMaxSites);
+    std::vector<NvStatsSymbol> symbols;
+    symbols.reserve(sites.size());
+    for (const auto& site : sites) {
+      symbols.push_back(SymbolOf(site.site));
+    }
+    WriteSection(segment_->sites, [&](NvStatsSites& section) {
+      section.site_count = sites.size();
+      for (size_t i = 0; i < sites.size(); ++i) {
+        auto& entry = section.sites[i];
+        entry.address = reinterpret_cast<uint64_t>(sites[i].site);
+        entry.bytes = sites[i].bytes;
+        entry.count = sites[i].count;
+        entry.symbol = symbols[i];
+      }
+    });
+  }
+  if ((detect_option_ & kDetectorOptionLock) != 0) {
+    LockCounters counters = LockDetect::GetInstance().GetCounters();
+    std::vector<LockStats> locks =
+        LockDetect::GetInstance().GetLockStats(kNvStatsMaxLocks);
+    WriteSection(segment_->lock, [&](NvStatsLocks& section) {
+      section.acquisitions = counters.acquisitions;
+      section.contended_acquisitions = counters.contended_acquisitions;
+      section.deadlocks_detected = counters.deadlocks_detected;
+      section.total_wait_ns = counters.total_wait_ns;
+      section.lock_count = locks.size();
+      for (size_t i = 0; i < locks.size(); ++i) {
+        section.locks[i] = {reinterpret_cast<uint64_t>(locks[i].lock_addr),
+                            locks[i].acquisitions,
+                            locks[i].contended_acquisitions, locks[i].wait_ns,
+                            locks[i].max_wait_ns};
+      }
+    });
+    std::vector<ThreadWaitStats> threads =
+        LockDetect::GetInstance().GetThreadWaitStats(kNvStatsMaxThreads);
+    WriteSection(segment_->threads, [&](NvStatsThreads& section) {
+      section.thread_count = threads.size();
+      for (size_t i = 0; i < threads.size(); ++i) {
+        section.threads[i] = {static_cast<uint64_t>(threads[i].tid),
+                              threads[i].acquisitions,
+                              threads[i].contended_acquisitions,
+                              threads[i].wait_ns};
+      }
+    });
+  }
+}
+}  // namespace tracker
@@ -0,0 +1,413 @@
+#include "thread_detect.h"
+
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "output_control.h"
+#include "overhead.h"
+#include "plthook.h"
+namespace tracker {
+struct ThreadRecord {
+  void* site;
+  bool detached;
+  bool exited;
+};
+class ThreadTracker {
+ public:
+  static auto GetInstance() -> ThreadTracker& {
+    static ThreadTracker instance;
+    return instance;
+  }
+  ThreadTracker(const ThreadTracker&) = delete;
+  auto operator=(const ThreadTracker&) -> ThreadTracker& = delete;
+  auto MarkStart() -> void { start_ = std::chrono::steady_clock::now(); }
+  auto RecordCreate(pthread_t thread, void* site, bool detached) -> void;
+  auto RecordCreateFailure() -> void {
+    create_failures_.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto RecordExit(pthread_t thread, void* site, uint64_t lifetime_ns) -> void;
+  auto RecordJoin(pthread_t thread) -> void;
+  auto RecordDetach(pthread_t thread) -> void;
+  auto RecordExplicitExit() -> void {
+    explicit_exits_.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto GetCounters() const -> ThreadCounters {
+    size_t created = created_.load(std::memory_order_relaxed);
+    size_t exited = exited_.load(std::memory_order_relaxed);
+    return {created,
+            exited,
+            joined_.load(std::memory_order_relaxed),
+            detached_.load(std::memory_order_relaxed),
+            explicit_exits_.load(std::memory_order_relaxed),
+            create_failures_.load(std::memory_order_relaxed),
+            created > exited ? created - exited : 0,
+            peak_live_.load(std::memory_order_relaxed)};
+  }
+  auto GetCreationSites(size_t count) const -> std::vector<ThreadSiteStats>;
+  auto PrintStatus(size_t count) const -> void;
+
+ private:
+  ThreadTracker() = default;
+  mutable std::mutex mutex_;
+  // Threads that are still joinable or still running. Detached threads
+  // leave once they exit, joined ones once joined.
+  std::unordered_map<pthread_t, ThreadRecord> threads_;
+  // A new thread can finish before pthread_create returns to its creator.
+  std::unordered_set<pthread_t> early_exits_;
+  std::unordered_map<void*, ThreadSiteStats> sites_;
+  std::chrono::steady_clock::time_point start_ =
+      std::chrono::steady_clock::now();
+  std::atomic<size_t> created_ = 0;
+  std::atomic<size_t> exited_ = 0;
+  std::atomic<size_t> joined_ = 0;
+  std::atomic<size_t> detached_ = 0;
+  std::atomic<size_t> explicit_exits_ = 0;
+  std::atomic<size_t> create_failures_ = 0;
+  std::atomic<size_t> peak_live_ = 0;
+};
+static auto Instance() -> ThreadTracker& {
+  return ThreadTracker::GetInstance();
+}
+auto ThreadTracker::RecordCreate(pthread_t thread, void* site, bool detached)
+    -> void {
+  size_t created = created_.fetch_add(1, std::memory_order_relaxed) + 1;
+  size_t exited = exited_.load(std::memory_order_relaxed);
+  size_t live = created > exited ? created - exited : 0;
+  size_t peak = peak_live_.load(std::memory_order_relaxed);
+  while (live > peak && !peak_live_.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+  if (detached) {
+    detached_.fetch_add(1, std::memory_order_relaxed);
+  }
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& site_stats = sites_[site];
+  site_stats.site = site;
+  site_stats.created++;
+  bool exited_already = early_exits_.erase(thread) != 0;
+  if (!(detached && exited_already)) {
+    threads_[thread] = {site, detached, exited_already};
+  }
+}
+auto ThreadTracker::RecordExit(pthread_t thread, void* site,
+                               uint64_t lifetime_ns) -> void {
+  exited_.fetch_add(1, std::memory_order_relaxed);
+  size_t bucket = LatencyBucket(lifetime_ns);
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& site_stats = sites_[site];
+  site_stats.site = site;
+  site_stats.exited++;
+  site_stats.total_lifetime_ns += lifetime_ns;
+  site_stats.max_lifetime_ns =
+      std::max(site_stats.max_lifetime_ns, lifetime_ns);
+  site_stats.lifetime[bucket]++;
+  auto it = threads_.find(thread);
+  if (it == threads_.end()) {
+    early_exits_.insert(thread);
+  } else if (it->second.detached) {
+    threads_.erase(it);
+  } else {
+    it->second.exited = true;
+  }
+}
+auto ThreadTracker::RecordJoin(pthread_t thread) -> void {
+  joined_.fetch_add(1, std::memory_order_relaxed);
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
+  threads_.erase(thread);
+}
+auto ThreadTracker::RecordDetach(pthread_t thread) -> void {
+  detached_.fetch_add(1, std::memory_order_relaxed);
+  PhaseScope table(OverheadPhase::kTable);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = threads_.find(thread);
+  if (it == threads_.end()) {
+    return;
+  }
+  if (it->second.exited) {
+    threads_.erase(it);
+  } else {
+    it->second.detached = true;
+  }
+}
+auto ThreadTracker::GetCreationSites(size_t count) const
+    -> std::vector<ThreadSiteStats> {
+  std::vector<ThreadSiteStats> result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<void*, size_t> never_joined;
+    for (const auto& pair : threads_) {
+      if (pair.second.exited && !pair.second.detached) {
+        never_joined[pair.second.site]++;
+      }
+    }
+    result.reserve(sites_.size());
+    for (const auto& pair : sites_) {
+      result.push_back(pair.second);
+      auto it = never_joined.find(pair.first);
+      result.back().never_joined = it != never_joined.end() ? it->second : 0;
+    }
+  }
+  std::ranges::sort(result, [](const auto& lhs, const auto& rhs) {
+    return lhs.created > rhs.created;
+  });
+  if (result.size() > count) {
+    result.resize(count);
+  }
+  return result;
+}
+auto ThreadTracker::PrintStatus(size_t count) const -> void {
+  constexpr double kNsPerUs = 1000.0;
+  constexpr double kP50 = 0.5;
+  constexpr double kP99 = 0.99;
+  ThreadCounters counters = GetCounters();
+  std::vector<ThreadSiteStats> sites = GetCreationSites(SIZE_MAX);
+  size_t never_joined = 0;
+  for (const auto& site : sites) {
+    never_joined += site.never_joined;
+  }
+  if (sites.size() > count) {
+    sites.resize(count);
+  }
+  double elapsed_s = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start_)
+                         .count();
+  ReportSection section;
+  TRACKER_PRINT("\n\n=== Thread Lifecycle ===\n");
+  TRACKER_PRINT(
+      "Created: %zu (%.1f/s), exited: %zu, live: %zu (peak %zu), joined: "
+      "%zu, detached: %zu, pthread_exit: %zu, create failures: %zu\n",
+      counters.created,
+      elapsed_s > 0.0 ? static_cast<double>(counters.created) / elapsed_s
+                      : 0.0,
+      counters.exited, counters.live, counters.peak_live, counters.joined,
+      counters.detached, counters.explicit_exits, counters.create_failures);
+  if (never_joined != 0) {
+    TRACKER_WARNING("Exited but never joined or detached: %zu threads\n",
+                    never_joined);
+  }
+  if (!sites.empty()) {
+    TRACKER_PRINT("\nCreation sites (by threads created):\n");
+  }
+  for (size_t i = 0; i < sites.size(); ++i) {
+    const auto& site = sites[i];
+    Dl_info dlinfo;
+    const char* symbol = "??";
+    const char* module = "??";
+    if (site.site != nullptr && dladdr(site.site, &dlinfo) != 0) {
+      symbol = dlinfo.dli_sname != nullptr ? dlinfo.dli_sname : symbol;
+      module = dlinfo.dli_fname != nullptr ? dlinfo.dli_fname : module;
+    }
+    TRACKER_PRINT("[%zu] %p %s (%s)\n", i, site.site, symbol, module);
+    if (site.exited == 0) {
+      TRACKER_PRINT("    created: %zu, exited: 0\n", site.created);
+      continue;
+    }
+    uint64_t p50 = LatencyPercentile(site.lifetime, kP50, site.max_lifetime_ns);
+    uint64_t p99 = LatencyPercentile(site.lifetime, kP99, site.max_lifetime_ns);
+    TRACKER_PRINT(
+        "    created: %zu, exited: %zu, never joined: %zu, lifetime avg: "
+        "%.1f us, p50: %.1f us, p99: %.1f us, max: %.1f us\n",
+        site.created, site.exited, site.never_joined,
+        static_cast<double>(site.total_lifetime_ns) /
+            static_cast<double>(site.exited) / kNsPerUs,
+        static_cast<double>(p50) / kNsPerUs,
+        static_cast<double>(p99) / kNsPerUs,
+        static_cast<double>(site.max_lifetime_ns) / kNsPerUs);
+  }
+  TRACKER_PRINT("===========================\n");
+}
+// Lives in the new thread's TLS, so its destructor sees every way a thread
+// can end: returning from the start routine, pthread_exit from any module,
+// and cancellation.
+class ThreadExitRecorder {
+ public:
+  auto Arm(void* site, std::chrono::steady_clock::time_point created)
+      -> void {
+    site_ = site;
+    created_ = created;
+    armed_ = true;
+  }
+  ~ThreadExitRecorder() {
+    if (!armed_) {
+      return;
+    }
+    auto lifetime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - created_);
+    Instance().RecordExit(pthread_self(), site_,
+                          static_cast<uint64_t>(lifetime.count()));
+  }
+
+ private:
+  void* site_ = nullptr;
+  std::chrono::steady_clock::time_point created_;
+  bool armed_ = false;
+};
+static thread_local ThreadExitRecorder exit_recorder;
+struct ThreadStart {
+  void* (*routine)(void*);
+  void* arg;
+  void* site;
+  std::chrono::steady_clock::time_point created;
+};
+static auto ThreadTrampoline(void* raw) -> void* {
+  ThreadStart start = *static_cast<ThreadStart*>(raw);
+  delete static_cast<ThreadStart*>(raw);
+  exit_recorder.Arm(start.site, start.created);
+  return start.routine(start.arg);
+}
+}  // namespace tracker
+static auto HookedPthreadCreate(pthread_t* thread, const pthread_attr_t* attr,
+                                void* (*routine)(void*), void* arg) -> int {
+  void* site = tracker::CallSite(__builtin_return_address(0));
+  auto* start = new tracker::ThreadStart{routine, arg, site,
+                                         std::chrono::steady_clock::now()};
+  int result =
+      pthread_create(thread, attr, &tracker::ThreadTrampoline, start);
+  tracker::HookScope scope(tracker::HookKind::kPthreadCreate);
+  if (result != 0) {
+    delete start;
+    tracker::Instance().RecordCreateFailure();
+    return result;
+  }
+  int detach_state = PTHREAD_CREATE_JOINABLE;
+  if (attr != nullptr) {
+    pthread_attr_getdetachstate(attr, &detach_state);
+  }
+  tracker::Instance().RecordCreate(*thread, site,
+                                   detach_state == PTHREAD_CREATE_DETACHED);
+  return result;
+}
+static auto HookedPthreadJoin(pthread_t thread, void** retval) -> int {
+  int result = pthread_join(thread, retval);
+  if (result == 0) {
+    tracker::HookScope scope(tracker::HookKind::kPthreadJoin);
+    tracker::Instance().RecordJoin(thread);
+  }
+  return result;
+}
+static auto HookedPthreadDetach(pthread_t thread) -> int {
+  int result = pthread_detach(thread);
+  if (result == 0) {
+    tracker::HookScope scope(tracker::HookKind::kPthreadDetach);
+    tracker::Instance().RecordDetach(thread);
+  }
+  return result;
+}
+[[noreturn]] static auto HookedPthreadExit(void* retval) -> void {
+  {
+    tracker::HookScope scope(tracker::HookKind::kPthreadExit);
+    tracker::Instance().RecordExplicitExit();
+  }
+  pthread_exit(retval);
+}
+class ThreadHook {
+ public:
+  explicit ThreadHook(std::string lib_path) : lib_path_(std::move(lib_path)) {}
+  ~ThreadHook() = default;
+  auto Start() -> void;
+
+ private:
+  std::string lib_path_;
+  std::unique_ptr<PltHook> hook_;
+};
+auto ThreadHook::Start() -> void {
+  hook_ = PltHook::Create(lib_path_.c_str());
+  try {
+    std::vector<std::string> hooked_functions;
+    auto try_hook = [&](const char* symbol, void* hook_func) {
+      if (hook_->ReplaceFunction(symbol, hook_func, nullptr) ==
+          PltHook::ErrorCode::kSuccess) {
+        hooked_functions.emplace_back(symbol);
+      }
+    };
+    try_hook("pthread_create", reinterpret_cast<void*>(&HookedPthreadCreate));
+    try_hook("pthread_join", reinterpret_cast<void*>(&HookedPthreadJoin));
+    try_hook("pthread_detach", reinterpret_cast<void*>(&HookedPthreadDetach));
+    try_hook("pthread_exit", reinterpret_cast<void*>(&HookedPthreadExit));
+    tracker::ReportSection section;
+    auto& output = tracker::OutputControl::Instance();
+    output.PrintColored(tracker::Color::kGreen, tracker::Color::kReset,
+                        "Hooked thread functions: ");
+    for (size_t i = 0; i < hooked_functions.size(); ++i) {
+      TRACKER_PRINT("%s", hooked_functions[i].c_str());
+      if (i < hooked_functions.size() - 1) {
+        TRACKER_PRINT(", ");
+      }
+    }
+    TRACKER_PRINT("\n");
+  } catch (const std::exception& e) {
+    TRACKER_ERROR("Error starting thread tracking: %s", e.what());
+  }
+}
+class ThreadDetectImpl {
+ public:
+  ThreadDetectImpl() = default;
+  ~ThreadDetectImpl() = default;
+  auto Register(const std::string& lib_name) -> void;
+  auto RegisterMain() -> void;
+  auto Start() -> void;
+  auto Detect() -> void;
+  auto GetCounters() const -> ThreadCounters;
+  auto GetCreationSites(size_t count) const -> std::vector<ThreadSiteStats>;
+  auto PrintCreationSites(size_t count) -> void;
+
+ private:
+  std::vector<std::unique_ptr<ThreadHook>> hooks_;
+};
+auto ThreadDetectImpl::Register(const std::string& lib_name) -> void {
+  hooks_.emplace_back(std::make_unique<ThreadHook>(lib_name));
+}
+auto ThreadDetectImpl::RegisterMain() -> void {
+  hooks_.emplace_back(std::make_unique<ThreadHook>(std::string()));
+}
+auto ThreadDetectImpl::Start() -> void {
+  tracker::Instance().MarkStart();
+  tracker::OverheadAccounting::Instance().Start();
+  for (auto& hook : hooks_) {
+    hook->Start();
+  }
+}
+auto ThreadDetectImpl::Detect() -> void {
+  constexpr size_t kReportCount = 10;
+  tracker::Instance().PrintStatus(kReportCount);
+}
+auto ThreadDetectImpl::GetCounters() const -> ThreadCounters {
+  return tracker::Instance().GetCounters();
+}
+auto ThreadDetectImpl::GetCreationSites(size_t count) const
+    -> std::vector<ThreadSiteStats> {
+  return tracker::Instance().GetCreationSites(count);
+}
+auto ThreadDetectImpl::PrintCreationSites(size_t count) -> void {
+  tracker::Instance().PrintStatus(count);
+}
+ThreadDetect::ThreadDetect() : impl_(std::make_unique<ThreadDetectImpl>()) {}
+ThreadDetect::~ThreadDetect() = default;
+auto ThreadDetect::Register(const std::string& lib_name) -> void {
+  impl_->Register(lib_name);
+}
+auto ThreadDetect::RegisterMain() -> void { impl_->RegisterMain(); }
+auto ThreadDetect::Start() -> void { impl_->Start(); }
+auto ThreadDetect::Detect() -> void { impl_->Detect(); }
+auto ThreadDetect::GetCounters() const -> ThreadCounters {
+  return impl_->GetCounters();
+}
+auto ThreadDetect::GetCreationSites(size_t count) const
+    -> std::vector<ThreadSiteStats> {
+  return impl_->GetCreationSites(count);
+}
+auto ThreadDetect::PrintCreationSites(size_t count) -> void {
+  impl_->PrintCreationSites(count);
+}
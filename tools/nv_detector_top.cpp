@@ -0,0 +1,224 @@
+// nv_detector_top: live, top-like view of a process running the detector
+// with its stats segment enabled (DetectorStartStatsSegment or
+// NV_DETECTOR_SHM_INTERVAL_MS).
+//
+//   nv_detector_top <pid> [interval_ms]
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "stats_segment.h"
+namespace {
+constexpr unsigned kDefaultIntervalMs = 1000;
+constexpr size_t kTopRows = 10;
+constexpr double kBytesPerKb = 1024.0;
+constexpr double kNsPerMs = 1000000.0;
+constexpr double kMsPerSecond = 1000.0;
+volatile sig_atomic_t g_quit = 0;
+auto HandleQuit(int /*signo*/) -> void { g_quit = 1; }
+struct Sample {
+  NvStatsMemory memory{};
+  NvStatsSites sites{};
+  NvStatsLocks lock{};
+  NvStatsThreads threads{};
+};
+struct GrowingSite {
+  const NvStatsSite* site;
+  int64_t delta;
+};
+auto FormatBytes(double bytes) -> std::string {
+  constexpr std::array<const char*, 4> kUnits = {"B", "KB", "MB", "GB"};
+  size_t unit = 0;
+  while (std::abs(bytes) >= kBytesPerKb && unit + 1 < kUnits.size()) {
+    bytes /= kBytesPerKb;
+    ++unit;
+  }
+  std::array<char, 32> buffer{};
+  snprintf(buffer.data(), buffer.size(), "%.1f %s", bytes, kUnits[unit]);
+  return buffer.data();
+}
+auto MapSegment(int pid) -> const NvStatsSegment* {
+  std::string name = NvStatsSegmentName(pid);
+  int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+  if (fd < 0) {
+    fprintf(stderr, "nv_detector_top: cannot open %s: %s\n", name.c_str(),
+            strerror(errno));
+    return nullptr;
+  }
+  struct stat st{};
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(NvStatsSegment)) {
+    fprintf(stderr, "nv_detector_top: %s is too small\n", name.c_str());
+    close(fd);
+    return nullptr;
+  }
+  void* addr =
+      mmap(nullptr, sizeof(NvStatsSegment), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    fprintf(stderr, "nv_detector_top: mmap failed: %s\n", strerror(errno));
+    return nullptr;
+  }
+  const auto* segment = static_cast<const NvStatsSegment*>(addr);
+  if (segment->magic != kNvStatsMagic || segment->version != kNvStatsVersion ||
+      segment->size != sizeof(NvStatsSegment)) {
+    fprintf(stderr,
+            "nv_detector_top: %s has an incompatible layout (version %u, "
+            "expected %u)\n",
+            name.c_str(), segment->version, kNvStatsVersion);
+    munmap(addr, sizeof(NvStatsSegment));
+    return nullptr;
+  }
+  return segment;
+}
+auto ReadSample(const NvStatsSegment& segment, Sample* sample) -> bool {
+  return NvStatsReadSection(segment.memory, &sample->memory) &&
+         NvStatsReadSection(segment.sites, &sample->sites) &&
+         NvStatsReadSection(segment.lock, &sample->lock) &&
+         NvStatsReadSection(segment.threads, &sample->threads);
+}
+auto PrintMemory(const Sample& current, const Sample& previous,
+                 double seconds) -> void {
+  const NvStatsMemory& mem = current.memory;
+  uint64_t live = mem.active_bytes;
+  double alloc_rate =
+      static_cast<double>(mem.allocation_count -
+                          previous.memory.allocation_count) /
+      seconds;
+  double byte_rate = static_cast<double>(mem.total_allocated -
+                                         previous.memory.total_allocated) /
+                     seconds;
+  printf("Memory  live %s in %lu objects   alloc %.0f/s (%s/s)\n",
+         FormatBytes(static_cast<double>(live)).c_str(),
+         static_cast<unsigned long>(mem.active_allocations), alloc_rate,
+         FormatBytes(byte_rate).c_str());
+}
+// Sites are keyed by address; a site missing from the previous sample counts
+// as growing from zero.
+auto PrintGrowingSites(const Sample& current, const Sample& previous) -> void {
+  std::unordered_map<uint64_t, uint64_t> before;
+  for (size_t i = 0; i < previous.sites.site_count; ++i) {
+    before[previous.sites.sites[i].address] = previous.sites.sites[i].bytes;
+  }
+  std::vector<GrowingSite> growing;
+  for (size_t i = 0; i < current.sites.site_count; ++i) {
+    const NvStatsSite& site = current.sites.sites[i];
+    auto it = before.find(site.address);
+    uint64_t base = it == before.end() ? 0 : it->second;
+    growing.push_back(
+        {&site, static_cast<int64_t>(site.bytes) - static_cast<int64_t>(base)});
+  }
+  std::ranges::sort(growing, [](const auto& lhs, const auto& rhs) {
+    return lhs.delta > rhs.delta;
+  });
+  printf("\n%-18s %12s %12s %8s  %s\n", "SITE", "GROWTH", "LIVE", "COUNT",
+         "SYMBOL");
+  for (size_t i = 0; i < std::min(growing.size(), kTopRows); ++i) {
+    const NvStatsSite& site = *growing[i].site;
+    printf("0x%016lx %12s %12s %8lu  %s\n",
+           static_cast<unsigned long>(site.address),
+           FormatBytes(static_cast<double>(growing[i].delta)).c_str(),
+           FormatBytes(static_cast<double>(site.bytes)).c_str(),
+           static_cast<unsigned long>(site.count), site.symbol.data());
+  }
+}
+auto PrintLocks(const Sample& current) -> void {
+  const NvStatsLocks& lock = current.lock;
+  printf("\nLocks   acquisitions %lu   contended %lu   wait %.1f ms   "
+         "deadlocks %lu\n",
+         static_cast<unsigned long>(lock.acquisitions),
+         static_cast<unsigned long>(lock.contended_acquisitions),
+         static_cast<double>(lock.total_wait_ns) / kNsPerMs,
+         static_cast<unsigned long>(lock.deadlocks_detected));
+  printf("%-18s %12s %10s %12s %12s\n", "LOCK", "ACQUIRED", "CONTENDED",
+         "WAIT ms", "MAX ms");
+  for (size_t i = 0; i < std::min<size_t>(lock.lock_count, kTopRows); ++i) {
+    const NvStatsLock& entry = lock.locks[i];
+    printf("0x%016lx %12lu %10lu %12.2f %12.2f\n",
+           static_cast<unsigned long>(entry.address),
+           static_cast<unsigned long>(entry.acquisitions),
+           static_cast<unsigned long>(entry.contended_acquisitions),
+           static_cast<double>(entry.wait_ns) / kNsPerMs,
+           static_cast<double>(entry.max_wait_ns) / kNsPerMs);
+  }
+}
+auto PrintThreads(const Sample& current) -> void {
+  const NvStatsThreads& threads = current.threads;
+  printf("\n%-10s %12s %10s %12s\n", "TID", "ACQUIRED", "CONTENDED",
+         "WAIT ms");
+  for (size_t i = 0; i < std::min<size_t>(threads.thread_count, kTopRows);
+       ++i) {
+    const NvStatsThread& entry = threads.threads[i];
+    printf("%-10lu %12lu %10lu %12.2f\n", static_cast<unsigned long>(entry.tid),
+           static_cast<unsigned long>(entry.acquisitions),
+           static_cast<unsigned long>(entry.contended_acquisitions),
+           static_cast<double>(entry.wait_ns) / kNsPerMs);
+  }
+}
+}  // namespace
+auto main(int argc, char** argv) -> int {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <pid> [interval_ms]\n", argv[0]);
+    return 1;
+  }
+  int pid = atoi(argv[1]);
+  unsigned interval_ms = kDefaultIntervalMs;
+  if (argc > 2) {
+    interval_ms = static_cast<unsigned>(strtoul(argv[2], nullptr, 10));
+    interval_ms = std::max(interval_ms, 1U);
+  }
+  const NvStatsSegment* segment = MapSegment(pid);
+  if (segment == nullptr) {
+    return 1;
+  }
+  signal(SIGINT, HandleQuit);
+  signal(SIGTERM, HandleQuit);
+  std::string name = NvStatsSegmentName(pid);
+  Sample previous;
+  ReadSample(*segment, &previous);
+  auto previous_time = std::chrono::steady_clock::now();
+  while (g_quit == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    // the publisher unlinks the segment on DetectorStop and at exit
+    if (kill(pid, 0) != 0 && errno == ESRCH) {
+      printf("\nprocess %d exited\n", pid);
+      break;
+    }
+    Sample current;
+    if (!ReadSample(*segment, &current)) {
+      continue;
+    }
+    auto now = std::chrono::steady_clock::now();
+    double seconds =
+        std::chrono::duration<double, std::milli>(now - previous_time).count() /
+        kMsPerSecond;
+    // clear screen, cursor home
+    printf("\033[2J\033[H");
+    printf("nv_detector_top  pid %d  %s  every %u ms\n\n", pid, name.c_str(),
+           interval_ms);
+    PrintMemory(current, previous, seconds);
+    PrintGrowingSites(current, previous);
+    PrintLocks(current);
+    PrintThreads(current);
+    fflush(stdout);
+    previous = current;
+    previous_time = now;
+  }
+  munmap(const_cast<NvStatsSegment*>(segment), sizeof(NvStatsSegment));
+  return 0;
+}